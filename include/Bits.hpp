@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// @brief index of the lowest set bit of a non zero mask.
+inline int lowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
@@ -68,7 +68,7 @@ public:
 		this->position = pos;
 	}
 
-	const auto& getPVMatrix() const {
+	glm::mat4 getPVMatrix() const {
 		return this->projection * this->view;
 	}
 
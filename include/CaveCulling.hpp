@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "ChunkMap.hpp"
+
+class ChunkMesh2;
+
+namespace rendering {
+	struct RenderingContext;
+}
+
+// @class CaveCuller
+// @brief Finds the chunks that can be seen from the camera by walking the world
+//		breadth first from the camera's chunk. A chunk is entered through one of
+//		its faces and left through another only if the mesher found air linking
+//		both (see meshing::computeConnectivity), the walk never turns back towards
+//		the camera and never enters a chunk outside the frustum. Chunks it doesn't
+//		reach are hidden behind terrain, e.g. caves seen from the surface.
+class CaveCuller {
+public:
+	CaveCuller();
+	~CaveCuller() = default;
+
+	// @brief Walks @ctx.world from the camera, call it once per frame before
+	//		rendering. Reads the world and the frustum of @ctx.
+	void update(const rendering::RenderingContext& ctx);
+
+	// @brief true if the last update() reached @chunk. Everything is reachable
+	//		while disabled or if the camera is outside the loaded world.
+	bool isReachable(const ChunkMesh2& chunk) const;
+
+	void setEnabled(bool value) {
+		this->enabled = value;
+	}
+
+	bool isEnabled() const {
+		return this->enabled;
+	}
+
+	// @brief Chunks reached by the last update().
+	size_t reachableCount() const {
+		return this->reached;
+	}
+
+private:
+	struct Step {
+		ChunkMesh2* chunk;
+		glm::ivec3 coord;
+		// face of the chunk the walk came in through, -1 for the camera's chunk.
+		int entry;
+		// one bit per meshing::Face the walk has already moved towards.
+		unsigned directions;
+	};
+
+	// @brief Queues the neighbour of @from across @face unless the walk already
+	//		reached it or it is outside the frustum.
+	void enter(const rendering::RenderingContext& ctx, const Step& from, int face);
+
+private:
+	// breadth first queue, reused every frame.
+	std::vector<Step> queue;
+
+	// stamped on every chunk the walk reaches, bumped by each update().
+	uint32_t stamp;
+
+	// false when the last update() didn't cull, then everything is reachable.
+	bool active;
+
+	bool enabled;
+
+	size_t reached;
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include <glm/vec3.hpp>
+
+// @class ChunkMap
+// @brief Sparse map from signed chunk coordinates to T. Open addressing with
+//		linear probing over keys packed in 64 bits, so insert, erase and lookups
+//		(neighbours included) are O(1) and the world can extend in every direction.
+//		Coordinates must fit in 21 bit signed integers (+-1048575 chunks).
+template<typename T>
+class ChunkMap {
+public:
+	ChunkMap(size_t initialCapacity = 64)
+		:slots{},
+		count{ 0 } {
+		size_t capacity = 16;
+		while (capacity < initialCapacity)
+			capacity *= 2;
+		this->slots.assign(capacity, Slot{ EMPTYKEY, T{} });
+	}
+
+	~ChunkMap() = default;
+
+public:
+	static uint64_t packKey(const glm::ivec3& coord) {
+		return ((uint64_t(coord.x) & COORDMASK) << 42)
+			| ((uint64_t(coord.y) & COORDMASK) << 21)
+			| (uint64_t(coord.z) & COORDMASK);
+	}
+
+	static glm::ivec3 unpackKey(uint64_t key) {
+		// shift the 21 bit fields to the top and back to sign extend them.
+		return {
+			static_cast<int>(static_cast<int64_t>(key << 1) >> 43),
+			static_cast<int>(static_cast<int64_t>(key << 22) >> 43),
+			static_cast<int>(static_cast<int64_t>(key << 43) >> 43),
+		};
+	}
+
+	// @brief Returns a pointer to the value stored at @coord or nullptr.
+	T* find(const glm::ivec3& coord) {
+		const auto key = packKey(coord);
+
+		for (size_t i = this->slotOf(key);; i = this->next(i)) {
+			if (this->slots[i].key == key)
+				return &this->slots[i].value;
+			if (this->slots[i].key == EMPTYKEY)
+				return nullptr;
+		}
+	}
+
+	const T* find(const glm::ivec3& coord) const {
+		return const_cast<ChunkMap*>(this)->find(coord);
+	}
+
+	// @brief Returns the value stored next to @coord, @offset away, or nullptr.
+	T* neighbour(const glm::ivec3& coord, const glm::ivec3& offset) {
+		return this->find(coord + offset);
+	}
+
+	bool contains(const glm::ivec3& coord) const {
+		return this->find(coord) != nullptr;
+	}
+
+	// @brief Stores @value at @coord, replacing the previous value if any.
+	// @returns true if @coord wasn't in the map.
+	bool insert(const glm::ivec3& coord, T value) {
+		// keep the load factor under 1/2 so probe sequences stay short.
+		if ((this->count + 1) * 2 > this->slots.size())
+			this->rehash(this->slots.size() * 2);
+
+		const auto key = packKey(coord);
+
+		for (size_t i = this->slotOf(key);; i = this->next(i)) {
+			if (this->slots[i].key == key) {
+				this->slots[i].value = std::move(value);
+				return false;
+			}
+			if (this->slots[i].key == EMPTYKEY) {
+				this->slots[i] = Slot{ key, std::move(value) };
+				this->count++;
+				return true;
+			}
+		}
+	}
+
+	// @returns true if @coord was in the map.
+	bool erase(const glm::ivec3& coord) {
+		const auto key = packKey(coord);
+
+		size_t hole = this->slotOf(key);
+		for (;; hole = this->next(hole)) {
+			if (this->slots[hole].key == EMPTYKEY)
+				return false;
+			if (this->slots[hole].key == key)
+				break;
+		}
+
+		// backward shift deletion: move back every following entry that would
+		// no longer be reachable from its home slot, so no tombstones are needed.
+		for (size_t i = this->next(hole); this->slots[i].key != EMPTYKEY; i = this->next(i)) {
+			const auto home = this->slotOf(this->slots[i].key);
+			const auto distanceToHole = (hole - home) & this->mask();
+			const auto distanceToSlot = (i - home) & this->mask();
+
+			if (distanceToHole <= distanceToSlot) {
+				this->slots[hole] = std::move(this->slots[i]);
+				hole = i;
+			}
+		}
+
+		this->slots[hole] = Slot{ EMPTYKEY, T{} };
+		this->count--;
+		return true;
+	}
+
+	// @brief Calls @fn(const glm::ivec3& coord, T& value) for every entry. The map
+	//		must not be modified from @fn.
+	template<typename F>
+	void forEach(F&& fn) {
+		for (auto& slot : this->slots)
+			if (slot.key != EMPTYKEY)
+				fn(unpackKey(slot.key), slot.value);
+	}
+
+	size_t size() const {
+		return this->count;
+	}
+
+	bool empty() const {
+		return this->count == 0;
+	}
+
+	void clear() {
+		this->slots.assign(this->slots.size(), Slot{ EMPTYKEY, T{} });
+		this->count = 0;
+	}
+
+private:
+	struct Slot {
+		uint64_t key;
+		T value;
+	};
+
+	// packed keys only use 63 bits, so this is never a valid key.
+	static constexpr uint64_t EMPTYKEY = ~uint64_t(0);
+	static constexpr uint64_t COORDMASK = (uint64_t(1) << 21) - 1;
+
+	size_t mask() const {
+		return this->slots.size() - 1;
+	}
+
+	size_t next(size_t i) const {
+		return (i + 1) & this->mask();
+	}
+
+	size_t slotOf(uint64_t key) const {
+		// splitmix64 finalizer, neighbouring chunks must not land in neighbouring slots.
+		key ^= key >> 30;
+		key *= 0xbf58476d1ce4e5b9ull;
+		key ^= key >> 27;
+		key *= 0x94d049bb133111ebull;
+		key ^= key >> 31;
+		return static_cast<size_t>(key) & this->mask();
+	}
+
+	void rehash(size_t capacity) {
+		auto old = std::move(this->slots);
+		this->slots.assign(capacity, Slot{ EMPTYKEY, T{} });
+
+		for (auto& slot : old) {
+			if (slot.key == EMPTYKEY)
+				continue;
+
+			size_t i = this->slotOf(slot.key);
+			while (this->slots[i].key != EMPTYKEY)
+				i = this->next(i);
+
+			this->slots[i] = std::move(slot);
+		}
+	}
+
+private:
+	std::vector<Slot> slots;
+	size_t count;
+};
@@ -6,11 +6,15 @@
 
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
+#include <glm/common.hpp>
 
 #include "Rendering.hpp"
 #include "ShaderCreation.hpp"
 #include "TextureLoader.h"
 #include "Config.hpp"
+#include "ChunkMesher.hpp"
+#include "VoxelStorage.hpp"
+#include "TerrainGenerator.hpp"
 
 // @struct ChunkMesh
 // @brief collection of all the vertices conforming a chunk and responsible of
@@ -19,38 +23,143 @@
 class ChunkMesh2 : public rendering::RenderObject {
 public:
 	using u8 = uint8_t;
-	using Voxel3DArray = std::array<std::array<std::array<uint8_t, CHUNKSIZE>, CHUNKSIZE>, CHUNKSIZE>;
+	using MeshingMode = meshing::MeshingMode;
+
+	// @brief What a generated chunk holds, decides the fast paths it takes.
+	enum class Contents {
+		Empty,	// only air: never meshed nor drawn.
+		Solid,	// no air: has no visible face unless a face neighbour isn't solid.
+		Mixed,
+	};
 
 	ChunkMesh2(const glm::vec3& startPosition);
 	~ChunkMesh2() = default;
 
 public:
-	// @brief generates a chunk. Populating the @vertices vector.
-	// @param startPosition the starting X and Z positions in which a chunk will
-	//			be generated. The starting Y component of a chunk will always be Y = 0
-	//			the chunk will be generated in the directions of +X +Z and +Y
-	void generateChunk();
+	// @brief Runs generation @stage on the chunk. Only writes the chunk's own
+	//		storage, so chunks can be generated in parallel on worker threads.
+	//		Nothing else may read the voxels until the chunk is generated.
+	// @param heightmaps heightmaps around the chunk, only read by the stages
+	//		that terrain::needsNeighbours().
+	void generateStage(terrain::Stage stage, const terrain::HeightmapNeighbourhood* heightmaps);
+
+	// @brief Called from the render thread when a generateStage() job is submitted.
+	void beginStage() {
+		this->stageRunning = true;
+	}
+
+	// @brief Called from the render thread once generateStage(@stage) has finished.
+	void finishStage(terrain::Stage stage) {
+		this->stage = stage;
+		this->stageRunning = false;
+	}
+
+	terrain::Stage getStage() const {
+		return this->stage;
+	}
 
-	// @brief Naive oclusion culling algorithm
-	void generateMesh(const rendering::RenderingContext& ctx);
+	bool isStageRunning() const {
+		return this->stageRunning;
+	}
+
+	// @brief true once every generation stage has completed.
+	bool isGenerated() const {
+		return this->stage == terrain::LASTSTAGE;
+	}
+
+	// @brief Computes the Contents of the chunk, call it once it is generated.
+	void classify();
+
+	Contents getContents() const {
+		return this->contents;
+	}
+
+	bool isEmpty() const {
+		return this->contents == Contents::Empty;
+	}
+
+	// @brief Amount of voxel layers at the bottom of the chunk without any air,
+	//		set by classify(). They can hide what is behind them.
+	int getSolidLayers() const {
+		return this->solidLayers;
+	}
+
+	// @brief true if the chunk and its 6 face neighbours in @ctx.world are solid,
+	//		so none of its faces can be seen.
+	bool isBuried(const rendering::RenderingContext& ctx) const;
+
+	// @brief Replaces the mesh drawn by the chunk. Meshes are built off the
+	//		render thread by the MeshingPipeline.
+	void uploadMesh(const meshing::MeshBuffers& mesh);
+
+	// @brief Copies the voxels of the chunk and the border shared with its 26
+	//		neighbours in @ctx.world into @out. Neighbours that aren't generated
+	//		yet are taken as void.
+	void captureSnapshot(const rendering::RenderingContext& ctx, meshing::ChunkSnapshot& out) const;
 
 	void render(const rendering::RenderingContext& ctx);
 
+	// @brief Tests the tight bounds of the uploaded mesh, a chunk without
+	//		geometry is never in the frustum.
 	bool inFrustum(const rendering::RenderingContext& ctx);
 
+	// @brief Same test for the bounds @mesh would have once uploaded.
+	bool inFrustum(const rendering::RenderingContext& ctx, const meshing::MeshBuffers& mesh) const;
+
+	// @brief Tight bounds of the uploaded mesh, empty if it has no geometry.
+	bool getBounds(glm::vec3& min, glm::vec3& max) const override;
+
+	// @brief true if @ctx.caveCuller didn't reach the chunk this frame or
+	//		@ctx.occlusionCuller finds its mesh hidden.
+	bool isOccluded(const rendering::RenderingContext& ctx) const override;
+
+	// @brief Face pairs linked through the chunk's air, from the last uploaded
+	//		mesh. Chunks that weren't meshed (yet) connect every face.
+	meshing::FaceConnectivity getConnectivity() const {
+		return this->connectivity;
+	}
+
+	// @brief Marker written by the CaveCuller on the chunks it reaches.
+	uint32_t getVisitStamp() const {
+		return this->visitStamp;
+	}
+
+	void setVisitStamp(uint32_t value) {
+		this->visitStamp = value;
+	}
+
 public:
-	rendering::MultipleBufferVAO& getVAO() {
+	// @brief Selects the meshing algorithm used by every chunk. Only affects
+	//		chunks queued for meshing after the call.
+	static void setMeshingMode(MeshingMode mode) {
+		meshingMode = mode;
+	}
+
+	static MeshingMode getMeshingMode() {
+		return meshingMode;
+	}
+
+	rendering::InterleavedVAO& getVAO() {
 		return this->vao;
 	}
 
 	dlb::ShaderProgram& getSP() {
-		return this->shaderProgram;
+		return *this->shaderProgram;
+	}
+
+	VoxelStorage& getVoxels() {
+		return this->voxels;
 	}
 
-	Voxel3DArray& getVoxels() {
+	const VoxelStorage& getVoxels() const {
 		return this->voxels;
 	}
 
+	// @brief Surface heights of the chunk's columns, filled by the BaseDensity stage.
+	const terrain::Heightmap& getHeightmap() const {
+		return this->heightmap;
+	}
+
 	void setId(int v) {
 		this->id = v;
 	}
@@ -59,6 +168,11 @@ public:
 		return startPosition;
 	}
 
+	// @brief Coordinates of the chunk in the world's ChunkMap.
+	glm::ivec3 getChunkCoord() const {
+		return glm::ivec3(glm::floor(this->startPosition));
+	}
+
 private:
 
 	// @vertices is a collection of all the vertices that conform a chunk,
@@ -69,16 +183,39 @@ private:
 	//std::vector<float> textureVertices;
 	//std::vector<float> visibleVertices;
 
-	Voxel3DArray voxels;
+	VoxelStorage voxels;
+
+	terrain::Heightmap heightmap;
 
 	int id;
 
+	// last generation stage completed and whether a stage job is in flight,
+	// only read and written by the render thread.
+	terrain::Stage stage;
+	bool stageRunning;
+
+	// Mixed and 0 until classify() is called.
+	Contents contents;
+	int solidLayers;
+
 	glm::vec3 startPosition;
 
-	dlb::ShaderProgram shaderProgram;
-	dlb::TextureLoader textureLoader;
+	// owned by dlb::ResourceCache, shared with every other chunk.
+	dlb::ShaderProgram* shaderProgram;
+	dlb::TextureLoader* textureLoader;
+
+	// the only uniform set per chunk, everything else is in the FrameUniforms block.
+	dlb::UniformLocation chunkOffsetUniform;
+
+	rendering::InterleavedVAO vao;
+
+	// world space bounds of the uploaded mesh.
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+
+	meshing::FaceConnectivity connectivity;
 
-	rendering::MultipleBufferVAO vao;
+	uint32_t visitStamp;
 
-	bool meshUpdate = true;
+	static MeshingMode meshingMode;
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "VoxelStorage.hpp"
+
+namespace meshing {
+	// A column of voxels along one axis packed as bits. Bit 0 and bit CHUNKSIZE + 1
+	// hold the voxels of the neighbouring chunks, the chunk itself uses bits 1..CHUNKSIZE.
+	using ColumnMask = std::conditional_t<(CHUNKSIZE + 2 <= 32), uint32_t, uint64_t>;
+
+	static_assert(CHUNKSIZE + 2 <= 64, "a padded voxel column must fit in a 64 bit word");
+
+	constexpr const int COLUMNS = CHUNKSIZE * CHUNKSIZE;
+
+	constexpr const int PADDEDSIZE = CHUNKSIZE + 2;
+
+	// @struct ChunkSnapshot
+	// @brief Copy of the voxels of a chunk plus a one voxel border taken from its
+	//		26 neighbours. It is all the mesher reads, so it can be meshed without
+	//		touching the live world (e.g. from another thread).
+	struct ChunkSnapshot {
+		// indexed as [(x * PADDEDSIZE + y) * PADDEDSIZE + z] with every coordinate
+		// shifted by one, so the chunk's own voxels live in 1..CHUNKSIZE.
+		std::array<VoxelId, PADDEDSIZE * PADDEDSIZE * PADDEDSIZE> voxels;
+
+		// @param x, y, z chunk relative coordinates in the range -1..CHUNKSIZE
+		VoxelId& at(int x, int y, int z) {
+			return voxels[((x + 1) * PADDEDSIZE + (y + 1)) * PADDEDSIZE + (z + 1)];
+		}
+
+		VoxelId at(int x, int y, int z) const {
+			return voxels[((x + 1) * PADDEDSIZE + (y + 1)) * PADDEDSIZE + (z + 1)];
+		}
+	};
+
+	// faces are ordered in pairs along each axis, so (face / 2) is the axis the
+	// face is perpendicular to and (face % 2) tells if it points to the positive side.
+	enum Face {
+		Left,	// -X
+		Right,	// +X
+		Bottom,	// -Y
+		Top,	// +Y
+		Front,	// -Z
+		Back,	// +Z
+		FaceCount
+	};
+
+	// @brief How the visible voxel faces are turned into quads.
+	enum class MeshingMode {
+		Naive,	// one quad per visible voxel face.
+		Greedy,	// coplanar faces with the same voxel id are merged into maximal rectangles.
+	};
+
+	// Columns are indexed as [v * CHUNKSIZE + u] where u and v are the two axes that
+	// follow the column axis: X -> (Y, Z), Y -> (Z, X), Z -> (X, Y).
+	struct OccupancyColumns {
+		std::array<std::array<ColumnMask, COLUMNS>, 3> axis;
+	};
+
+	// Bit i of a column is set if voxel i along the face axis has a visible face
+	// in that direction. Indexed like OccupancyColumns.
+	struct FaceMasks {
+		std::array<std::array<ColumnMask, COLUMNS>, FaceCount> faces;
+	};
+
+	// A chunk vertex packed in 32 bits, decoded by chunk.vert:
+	//	bits  0..5	x (chunk relative, 0..CHUNKSIZE)
+	//	bits  6..11	y
+	//	bits 12..17	z
+	//	bits 18..20	face (see Face), the shader looks the normal up with it
+	//	bits 21..31	voxel id, only the low 11 bits of it reach the shader
+	using PackedVertex = uint32_t;
+
+	constexpr const int MAXVOXELID = (1 << 11) - 1;
+
+	static_assert(CHUNKSIZE < 64, "chunk relative vertex positions are packed in 6 bits");
+
+	constexpr PackedVertex packVertex(int x, int y, int z, int face, int voxel) {
+		return PackedVertex(x)
+			| (PackedVertex(y) << 6)
+			| (PackedVertex(z) << 12)
+			| (PackedVertex(face) << 18)
+			| (PackedVertex(voxel & MAXVOXELID) << 21);
+	}
+
+	// Which pairs of chunk faces are linked by a path through the chunk's air
+	// voxels, one bit per unordered pair of faces (15 bits, see facePairBit()).
+	using FaceConnectivity = uint16_t;
+
+	constexpr const FaceConnectivity ALLFACESCONNECTED = (1 << 15) - 1;
+
+	// @brief Bit of the pair (@a, @b) in a FaceConnectivity, @a != @b.
+	constexpr int facePairBit(int a, int b) {
+		if (a > b) {
+			const int t = a;
+			a = b;
+			b = t;
+		}
+		// pairs are numbered (0, 1), (0, 2) .. (0, 5), (1, 2) .. (4, 5).
+		return a * (2 * FaceCount - a - 1) / 2 + (b - a - 1);
+	}
+
+	constexpr bool facesConnected(FaceConnectivity connectivity, int a, int b) {
+		return (connectivity >> facePairBit(a, b)) & 1;
+	}
+
+	static_assert(facePairBit(Front, Back) == 14, "face pairs must fit in 15 bits");
+
+	// every quad is emitted as 4 vertices and drawn with 6 indices.
+	constexpr const int VERTICESPERQUAD = 4;
+	constexpr const int INDICESPERQUAD = 6;
+
+	struct MeshBuffers {
+		std::vector<PackedVertex> vertices;
+
+		// tight box around the emitted quads, in chunk relative vertex
+		// coordinates (0..CHUNKSIZE). Only meaningful if !empty().
+		glm::ivec3 boundsMin{ CHUNKSIZE };
+		glm::ivec3 boundsMax{ 0 };
+
+		// a chunk without air (e.g. a buried one uploaded with no mesh) connects nothing.
+		FaceConnectivity connectivity = 0;
+
+		size_t quadCount() const {
+			return vertices.size() / VERTICESPERQUAD;
+		}
+
+		bool empty() const {
+			return vertices.empty();
+		}
+	};
+
+	// @brief Copies @voxels into the interior of the snapshot and sets the
+	//		whole border to void. Neighbours are copied in with copyBorder().
+	void beginSnapshot(const VoxelStorage& voxels, ChunkSnapshot& out);
+
+	// @brief Copies the voxels of the neighbour at @offset (each component in
+	//		-1..1) that touch the snapshotted chunk into the border of the snapshot.
+	void copyBorder(const glm::ivec3& offset, const VoxelStorage& neighbour, ChunkSnapshot& out);
+
+	// @brief Packs the solid voxels of the chunk and the face-adjacent voxels of
+	//		its neighbours into bit columns along the three axes.
+	void buildOccupancy(const ChunkSnapshot& snapshot, OccupancyColumns& out);
+
+	// @brief Computes the visible faces of every column with shifts and AND-NOTs.
+	void cullFaces(const OccupancyColumns& occupancy, FaceMasks& out);
+
+	// @brief Emits one quad per visible face.
+	void emitNaive(const ChunkSnapshot& snapshot, const FaceMasks& masks, MeshBuffers& out);
+
+	// @brief Emits the visible faces of every slice merged into maximal rectangles
+	//		of the same voxel id.
+	void emitGreedy(const ChunkSnapshot& snapshot, const FaceMasks& masks, MeshBuffers& out);
+
+	// @brief Flood fills the air voxels of the chunk (the border is ignored) and
+	//		links every pair of faces touched by the same air region.
+	FaceConnectivity computeConnectivity(const ChunkSnapshot& snapshot);
+
+	// @brief Builds the mesh of the visible faces of a chunk. Vertex positions
+	//		are relative to the chunk's (0, 0, 0) voxel.
+	MeshBuffers generateMesh(MeshingMode mode, const ChunkSnapshot& snapshot);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "ChunkMap.hpp"
+#include "Rendering.hpp"
+#include "MeshingPipeline.hpp"
+#include "ThreadPool.hpp"
+#include "TerrainGenerator.hpp"
+
+class ChunkMesh2;
+
+// @class ChunkStreamer
+// @brief Keeps the chunks around the camera loaded. Chunks entering the load
+//		radius are generated nearest first on a pool of workers. Every generation
+//		stage (see terrain::Stage) of a chunk is a job that only writes the voxels
+//		of its own chunk, a stage that needsNeighbours() waits until the chunks
+//		around have completed the previous one. Fully generated chunks are handed
+//		to the MeshingPipeline together with their neighbours. Chunks
+//		further than the load radius plus a hysteresis margin are unloaded,
+//		which frees their voxels and GPU buffers. The margin keeps chunks from
+//		being reloaded over and over when the camera moves back and forth
+//		across a chunk border.
+//		The streamer owns every chunk it puts in the world.
+class ChunkStreamer {
+public:
+	// @param threadCount defaults to half of the workers, the other half meshes
+	//		the generated chunks in the MeshingPipeline.
+	ChunkStreamer(ChunkMap<ChunkMesh2*>& world, rendering::Renderer& renderer, MeshingPipeline& meshingPipeline,
+		unsigned int threadCount = ThreadPool::sharedThreadCount(2));
+
+	// @brief Waits for the running generation jobs and unloads every chunk.
+	~ChunkStreamer();
+
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+public:
+	// @brief Loads and unloads chunks around @cameraPosition. Call it once per frame.
+	void update(const glm::vec3& cameraPosition);
+
+	// @brief Waits for the running generation jobs and unloads every chunk.
+	//		Call it while the GL context is still alive.
+	void unloadAll();
+
+	// @param horizontal load radius in chunks on the XZ plane.
+	// @param vertical load radius in chunks along Y.
+	void setRadius(int horizontal, int vertical) {
+		this->horizontalRadius = horizontal;
+		this->verticalRadius = vertical;
+		this->dirty = true;
+	}
+
+	// @param chunks how much further than the load radius a chunk must be to be unloaded.
+	void setHysteresis(int chunks) {
+		this->hysteresis = chunks;
+		this->dirty = true;
+	}
+
+	// @param n new chunks are only loaded while there are less than @n
+	//		generation jobs in flight.
+	void setMaxGenerating(int n) {
+		this->maxGenerating = n;
+	}
+
+	size_t pendingLoads() const {
+		return this->loadQueue.size();
+	}
+
+	int generatingCount() const {
+		return this->generating;
+	}
+
+private:
+	bool inRadius(const glm::ivec3& coord, int horizontal, int vertical) const;
+
+	// @brief Rebuilds the load queue and unloads the chunks out of range.
+	void refresh();
+
+	void load(const glm::ivec3& coord);
+	void unload(const glm::ivec3& coord, ChunkMesh2* chunk);
+
+	// @brief Submits the next generation stage of @chunk if it can run.
+	void advance(ChunkMesh2* chunk);
+
+	// @brief Records the stages finished by the workers, queues the generated
+	//		chunks and their neighbours for meshing and schedules the next stages.
+	void collectGenerated();
+
+private:
+	ChunkMap<ChunkMesh2*>& world;
+	rendering::Renderer& renderer;
+	MeshingPipeline& meshingPipeline;
+
+	int horizontalRadius;
+	int verticalRadius;
+	int hysteresis;
+	int maxGenerating;
+
+	glm::ivec3 cameraChunk;
+
+	// true when the load queue must be rebuilt (camera changed chunk or radius changed).
+	bool dirty;
+
+	// chunks to load, the nearest one is at the back.
+	std::vector<glm::ivec3> loadQueue;
+
+	struct FinishedStage {
+		ChunkMesh2* chunk;
+		terrain::Stage stage;
+	};
+
+	// generation jobs submitted to the pool that haven't been collected yet.
+	int generating;
+
+	std::mutex generatedMutex;
+	std::vector<FinishedStage> generated;
+
+	// declared last so the workers are joined before the rest is destroyed.
+	ThreadPool pool;
+};
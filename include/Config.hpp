@@ -1,7 +1,33 @@
 #pragma once
 
+#include <cstddef>
+
 constexpr const int CHUNKSIZE = 16;
 
 constexpr const int CHUNKVOLUME = CHUNKSIZE * CHUNKSIZE * CHUNKSIZE;
 
-constexpr const int WORLDSIZE = 6;
\ No newline at end of file
+// radius (in chunks) of the circle the light moves along.
+constexpr const int WORLDSIZE = 6;
+
+// default radii (in chunks) of the ChunkStreamer around the camera.
+constexpr const int VIEWRADIUS = 8;
+constexpr const int VERTICALVIEWRADIUS = 4;
+constexpr const int STREAMINGHYSTERESIS = 2;
+// chunks being generated at once per generation worker.
+constexpr const int GENERATIONJOBSPERWORKER = 4;
+
+// most quads a chunk mesh can have, a 3D checkerboard where half of the voxels
+// expose their 6 faces.
+constexpr const int MAXCHUNKQUADS = 3 * CHUNKVOLUME;
+
+// size of the OcclusionCuller's depth buffer and most occluders drawn in it
+// every frame, the ones nearest to the camera are kept.
+constexpr const int OCCLUSIONBUFFERWIDTH = 256;
+constexpr const int OCCLUSIONBUFFERHEIGHT = 128;
+constexpr const int MAXOCCLUDERS = 512;
+// workers drawing the depth buffer along with the render thread.
+constexpr const unsigned int OCCLUSIONTHREADS = 2;
+
+// default budget the MeshingPipeline has every frame to upload finished meshes.
+constexpr const size_t MESHUPLOADBYTESPERFRAME = 512 * 1024;
+constexpr const float MESHUPLOADMSPERFRAME = 2.0f;
\ No newline at end of file
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "ChunkMap.hpp"
+#include "Frustum.hpp"
+
+namespace culling {
+	// Huge but finite extents, so a zero plane normal component times the extent
+	// is still 0 instead of NaN. They outweigh any position in the world.
+	constexpr const float UNBOUNDEDEXTENT = 1e30f;
+	constexpr const float EMPTYEXTENT = -1e30f;
+
+	enum class Containment {
+		Outside,
+		Intersect,
+		Inside,
+	};
+
+	// @class BoxArray
+	// @brief Axis aligned boxes stored as centres and half extents in separate
+	//		arrays, so the culling loops load several boxes per instruction.
+	//		Two special boxes exist: unbounded boxes are always visible and empty
+	//		boxes never are.
+	class BoxArray {
+	public:
+		BoxArray() = default;
+		~BoxArray() = default;
+
+	public:
+		// @returns the index of the new box.
+		uint32_t add(const glm::vec3& min, const glm::vec3& max);
+		uint32_t addUnbounded();
+
+		void set(uint32_t index, const glm::vec3& min, const glm::vec3& max);
+		void setUnbounded(uint32_t index);
+		void setEmpty(uint32_t index);
+
+		// @brief Moves the last box into @index and drops the last slot.
+		void removeSwap(uint32_t index);
+
+		void clear();
+
+		size_t size() const {
+			return this->centerX.size();
+		}
+
+	public:
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentX, extentY, extentZ;
+	};
+
+	// @brief Appends to @visible (after clearing it) the index of every box
+	//		of @boxes that is at least partly inside @frustum, in increasing order.
+	void cullBoxes(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& visible);
+
+	// @brief Like cullBoxes(), but splits the visible boxes between the ones
+	//		fully inside @frustum and the ones crossing its planes.
+	void classifyBoxes(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& inside, std::vector<uint32_t>& intersecting);
+
+	Containment classifyBox(const Frustum& frustum, const BoxArray& boxes, uint32_t index);
+
+	// regions are squares of REGIONCOLUMNS x REGIONCOLUMNS chunk columns.
+	constexpr const int REGIONCOLUMNS = 8;
+
+	// @class BoxHierarchy
+	// @brief Groups the boxes of a BoxArray by chunk column (the XZ position of
+	//		their centre) and the columns by region. Regions and then columns are
+	//		culled first: the ones outside of the frustum drop all their boxes
+	//		after a single test and the ones fully inside accept all of them
+	//		without testing them. Only the boxes of columns crossing the frustum
+	//		planes are tested one by one.
+	//		Unbounded boxes are always visible and empty boxes never are.
+	class BoxHierarchy {
+	public:
+		BoxHierarchy() = default;
+		~BoxHierarchy() = default;
+
+	public:
+		// @brief Places box @slot of @boxes, new or changed, in the hierarchy.
+		void update(uint32_t slot, const BoxArray& boxes);
+
+		// @brief Removes box @slot. Box @last, the last one, takes its place like
+		//		it does in BoxArray::removeSwap().
+		void remove(uint32_t slot, uint32_t last);
+
+		// @brief Writes the index of every visible box of @boxes in @visible.
+		void cull(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& visible);
+
+		size_t regionCount() const {
+			return this->regions.size();
+		}
+
+	private:
+		struct Column {
+			glm::ivec3 coord;
+			std::vector<uint32_t> slots;
+		};
+
+		struct Region {
+			std::vector<Column> columns;
+
+			// bounds of the columns (in the same order) and of the whole region,
+			// recomputed before culling when the region is dirty.
+			BoxArray columnBounds;
+			glm::vec3 min;
+			glm::vec3 max;
+			bool dirty;
+		};
+
+		enum class Placement {
+			None,	// empty box, never visible.
+			Loose,	// unbounded box, always visible.
+			Grouped,
+		};
+
+		struct SlotInfo {
+			Placement placement;
+			glm::ivec3 column;
+		};
+
+		static glm::ivec3 regionOf(const glm::ivec3& column);
+
+		// @brief Takes @slot out of the list it is in.
+		void detach(uint32_t slot);
+
+		void refresh(Region& region, const BoxArray& boxes);
+
+	private:
+		std::vector<SlotInfo> slots;
+		std::vector<uint32_t> loose;
+
+		ChunkMap<Region> regions;
+
+		// reused every frame.
+		BoxArray regionBounds;
+		std::vector<Region*> regionList;
+		std::vector<uint32_t> insideRegions, intersectingRegions;
+		std::vector<uint32_t> insideColumns, intersectingColumns;
+	};
+
+	// @class DistanceSorter
+	// @brief Orders box indices nearest first by the distance from a point to the
+	//		box centres. The squared distances are quantized to 16 bits (about 1/256
+	//		of the distance) and sorted with a two pass radix sort, so the cost is
+	//		linear in the amount of boxes. Boxes at the same quantized distance keep
+	//		their order. Unbounded boxes come first.
+	class DistanceSorter {
+	public:
+		DistanceSorter() = default;
+		~DistanceSorter() = default;
+
+	public:
+		// @brief Sorts @indices (into @boxes) nearest to @eye first. Walking the
+		//		result backwards gives the back to front order.
+		void sort(const BoxArray& boxes, const glm::vec3& eye, std::vector<uint32_t>& indices);
+
+	private:
+		// reused every call.
+		std::vector<uint16_t> keys, sortedKeys;
+		std::vector<uint32_t> sortedIndices;
+	};
+}
@@ -47,6 +47,13 @@ public:
 	bool pointIn(const glm::vec3& point);
 	bool boxIn(const std::array<glm::vec3, 8>& box);
 
+	// @brief true if the axis aligned box is at least partly inside the frustum.
+	bool aabbIn(const glm::vec3& min, const glm::vec3& max) const;
+
+	const std::array<Plane, FrustumFaces::Count>& getPlanes() const {
+		return this->planes;
+	}
+
 private:
 	std::array<Plane, FrustumFaces::Count> planes;
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Rendering.hpp"
+#include "ChunkMesher.hpp"
+#include "ThreadPool.hpp"
+
+class ChunkMesh2;
+
+// @class MeshingPipeline
+// @brief Meshes dirty chunks on worker threads. The render thread only takes the
+//		snapshots of the queued chunks and uploads the finished meshes, so it never
+//		waits for the mesher. A chunk keeps drawing its previous mesh until the
+//		new one is uploaded.
+//		Uploads are limited by a per frame byte and time budget, visible chunks
+//		closest to the camera go first.
+class MeshingPipeline {
+public:
+	// @param renderer gets the new bounds of the chunks whose mesh is uploaded.
+	// @param threadCount defaults to half of the workers, the ChunkStreamer
+	//		generating the chunks keeps the other half busy.
+	MeshingPipeline(rendering::Renderer& renderer, unsigned int threadCount = ThreadPool::sharedThreadCount(2));
+	~MeshingPipeline() = default;
+
+public:
+	// @brief Queues @chunk to be (re)meshed. Queuing a chunk that is already
+	//		being meshed makes the result in flight obsolete.
+	void enqueue(ChunkMesh2* chunk);
+
+	// @brief Drops every pending or in flight mesh of @chunk. Call it before
+	//		deleting a chunk.
+	void cancel(ChunkMesh2* chunk);
+
+	// @brief Must be called once per frame from the render thread. Uploads
+	//		finished meshes within the frame budget and sends the queued chunks
+	//		to the workers.
+	void update(const rendering::RenderingContext& ctx);
+
+	// @brief Sets how much mesh data can be uploaded per frame. At least one mesh
+	//		is uploaded every frame, whatever the budget.
+	// @param bytes maximum amount of vertex data uploaded per frame.
+	// @param milliseconds maximum time spent uploading per frame.
+	void setUploadBudget(size_t bytes, float milliseconds) {
+		this->uploadBytesBudget = bytes;
+		this->uploadTimeBudget = milliseconds;
+	}
+
+	size_t inFlight() const {
+		return this->latestTicket.size();
+	}
+
+	size_t pendingUploadCount() const {
+		return this->pendingUploads.size();
+	}
+
+private:
+	struct MeshResult {
+		ChunkMesh2* chunk;
+		uint64_t ticket;
+		meshing::MeshBuffers mesh;
+	};
+
+	bool isObsolete(const MeshResult& result) const;
+
+	void uploadFinished(const rendering::RenderingContext& ctx);
+	void submitQueued(const rendering::RenderingContext& ctx);
+
+private:
+	rendering::Renderer& renderer;
+
+	std::vector<ChunkMesh2*> queued;
+	std::unordered_set<ChunkMesh2*> queuedSet;
+
+	// ticket of the newest job of every chunk being meshed, results with an
+	// older ticket are obsolete. Tickets are never reused.
+	std::unordered_map<ChunkMesh2*, uint64_t> latestTicket;
+	uint64_t nextTicket;
+
+	std::mutex finishedMutex;
+	std::vector<MeshResult> finished;
+
+	// finished meshes waiting for upload budget, only touched by the render thread.
+	std::vector<MeshResult> pendingUploads;
+
+	size_t uploadBytesBudget;
+	float uploadTimeBudget;
+
+	// declared last so the workers are joined before the rest is destroyed.
+	ThreadPool pool;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+// Classic Perlin noise evaluated in batches. The values are the ones glm::perlin
+// returns (same operations in the same order), so switching to these functions
+// doesn't change the generated world. Batches run 8 (AVX2) or 4 (SSE2) points
+// at a time when the compiler targets those instruction sets, the remaining
+// points and other targets go through the scalar path, which computes the
+// exact same values.
+namespace noise {
+	float perlin(const glm::vec2& p);
+	float perlin(const glm::vec3& p);
+
+	// @brief Evaluates 2D noise at (@xs[i], @ys[i]) for i in [0, @count).
+	void perlin(const float* xs, const float* ys, int count, float* out);
+
+	// @brief Evaluates 3D noise at (@xs[i], @ys[i], @zs[i]) for i in [0, @count).
+	void perlin(const float* xs, const float* ys, const float* zs, int count, float* out);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "ThreadPool.hpp"
+
+namespace occlusion {
+	// points nearer than this (in clip space w) aren't projected. Occluders
+	// crossing it are dropped and boxes crossing it are always visible.
+	constexpr const float NEARW = 0.1f;
+
+	// side in pixels of the tiles whose farthest depth is kept next to the buffer.
+	constexpr const int DEPTHTILESIZE = 8;
+
+	// @struct Box
+	// @brief Axis aligned box in world space, fully solid when used as an occluder.
+	struct Box {
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	// @class DepthBuffer
+	// @brief Small depth buffer filled on the CPU with the faces of solid boxes,
+	//		used to find boxes hidden behind them. Depths are clip space w (the
+	//		distance along the view direction) and every face is written with the
+	//		depth of its farthest corner and only into the pixels it covers
+	//		entirely, so the buffer never holds anything nearer than the real
+	//		occluders, not even along their silhouettes. Needs no GL context.
+	class DepthBuffer {
+	public:
+		// @param width, height rounded up to a multiple of DEPTHTILESIZE.
+		DepthBuffer(int width, int height);
+		~DepthBuffer() = default;
+
+	public:
+		// @brief Clears the buffer and draws the faces of @occluders that face
+		//		@eye, projected with @pv. With a @pool the rows are split in bands
+		//		drawn in parallel, the call waits for all of them so the pool must
+		//		not be running other jobs.
+		void render(const glm::mat4& pv, const glm::vec3& eye, const std::vector<Box>& occluders, ThreadPool* pool = nullptr);
+
+		// @brief false if every pixel the box may cover holds something nearer
+		//		than its nearest corner. Uses the projection of the last render().
+		bool isVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+		int getWidth() const {
+			return this->width;
+		}
+
+		int getHeight() const {
+			return this->height;
+		}
+
+		// @brief Depth stored at pixel (@x, @y), +inf where nothing was drawn.
+		float depthAt(int x, int y) const {
+			return this->depths[y * this->width + x];
+		}
+
+		// @brief Faces drawn by the last render().
+		size_t quadCount() const {
+			return this->quads.size();
+		}
+
+	private:
+		// an occluder face projected to pixels. Corners go around the face.
+		struct ScreenQuad {
+			glm::vec2 corners[4];
+			float depth;
+			// pixels whose centre may be inside, clamped to the buffer.
+			int minX, minY, maxX, maxY;
+		};
+
+		// @brief Projects the faces of @occluders facing @eye into @quads.
+		void setup(const std::vector<Box>& occluders, const glm::vec3& eye);
+
+		// @brief Clears rows @firstRow..@lastRow - 1, draws every quad into them
+		//		and updates their tiles. Both must be multiples of DEPTHTILESIZE.
+		void rasterizeRows(int firstRow, int lastRow);
+
+		void rasterizeQuad(const ScreenQuad& quad, int firstRow, int lastRow);
+
+		// @returns the pixel coordinates of @clip in x, y and its depth in z.
+		glm::vec3 toScreen(const glm::vec4& clip) const;
+
+	private:
+		int width;
+		int height;
+
+		// row major, row 0 is the bottom of the screen.
+		std::vector<float> depths;
+
+		// farthest depth of every tile, row major. Tiles entirely nearer than a
+		// box hide it without reading their pixels.
+		std::vector<float> tileDepths;
+		int tilesX;
+
+		std::vector<ScreenQuad> quads;
+
+		glm::mat4 pv;
+	};
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "Occlusion.hpp"
+#include "ThreadPool.hpp"
+
+namespace rendering {
+	struct RenderingContext;
+}
+
+// @class OcclusionCuller
+// @brief Software occlusion culling. Every frame the solid bottom layers of the
+//		chunks in the frustum, merged into one box per run of chunks in a column,
+//		are drawn into a small occlusion::DepthBuffer on worker threads. Chunks
+//		then test their mesh bounds against it and the ones behind terrain
+//		aren't drawn. Runs entirely on the CPU, so it gives the same answer on
+//		every driver and never lags frames behind like GPU queries.
+class OcclusionCuller {
+public:
+	// @param threadCount workers drawing the depth buffer with the render thread.
+	OcclusionCuller(unsigned int threadCount = OCCLUSIONTHREADS);
+	~OcclusionCuller() = default;
+
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+public:
+	// @brief Redraws the depth buffer from @ctx.world, seen by @ctx.camera.
+	//		Call it once per frame before rendering.
+	void update(const rendering::RenderingContext& ctx);
+
+	// @brief true if the box is hidden behind the occluders of the last update().
+	bool isOccluded(const glm::vec3& min, const glm::vec3& max) const;
+
+	void setEnabled(bool value) {
+		this->enabled = value;
+	}
+
+	bool isEnabled() const {
+		return this->enabled;
+	}
+
+	void setMaxOccluders(size_t value) {
+		this->maxOccluders = value;
+	}
+
+	// @brief Occluders drawn by the last update().
+	size_t occluderCount() const {
+		return this->occluders.size();
+	}
+
+	const occlusion::DepthBuffer& getDepthBuffer() const {
+		return this->buffer;
+	}
+
+private:
+	// @brief Fills @occluders with the boxes of the runs of solid chunks in the
+	//		frustum, keeping the @maxOccluders nearest to the camera.
+	void collectOccluders(const rendering::RenderingContext& ctx);
+
+private:
+	std::vector<occlusion::Box> occluders;
+	occlusion::DepthBuffer buffer;
+
+	size_t maxOccluders;
+
+	bool enabled;
+
+	// false until the first update() with culling enabled.
+	bool active;
+
+	// declared last, so workers stop before the buffer goes away.
+	ThreadPool pool;
+};
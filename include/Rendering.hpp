@@ -2,17 +2,24 @@
 
 #include <vector>
 #include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include <type_traits>
 
 #include <glad/glad.h>
 
 #include "Config.hpp"
 #include "Types.hpp"
+#include "ChunkMap.hpp"
+#include "Culling.hpp"
 #include "ShaderCreation.hpp"
 #include "Camera.hpp"
 
 class Frustum;
 class LightSource;
 class ChunkMesh2;
+class CaveCuller;
+class OcclusionCuller;
 
 namespace rendering {
 	struct RenderingContext {
@@ -21,15 +28,95 @@ namespace rendering {
 		float lastTime;
 		Frustum* frustum;
 		LightSource* lightSource;
-		Array3D<ChunkMesh2*, WORLDSIZE, WORLDSIZE, WORLDSIZE>* world;
+		ChunkMap<ChunkMesh2*>* world;
+		// optional, chunks it doesn't reach are skipped.
+		const CaveCuller* caveCuller = nullptr;
+		// optional, chunks hidden in its depth buffer are skipped.
+		const OcclusionCuller* occlusionCuller = nullptr;
+	};
+
+	// binding point of the FrameUniforms block declared by the chunk and light shaders.
+	constexpr const GLuint FRAMEUNIFORMSBINDING = 0;
+	constexpr const char* FRAMEUNIFORMSBLOCK = "FrameUniforms";
+
+	// @struct FrameUniforms
+	// @brief CPU side of the std140 FrameUniforms block, vec3s are padded to vec4.
+	struct FrameUniforms {
+		glm::mat4 projectionView;
+		glm::vec4 lightPosition;
+		glm::vec4 lightColor;
+		glm::vec4 viewPosition;
+	};
+
+	// @class FrameUniformBuffer
+	// @brief Uniform buffer with the camera and light state shared by every draw
+	//		of a frame. Filled once per frame and bound to FRAMEUNIFORMSBINDING,
+	//		programs reading it must call
+	//		bindUniformBlock(FRAMEUNIFORMSBLOCK, FRAMEUNIFORMSBINDING) once.
+	class FrameUniformBuffer {
+	public:
+		FrameUniformBuffer();
+		~FrameUniformBuffer();
+
+		FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+		FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+	public:
+		void update(FPSCamera& camera, LightSource& light);
+
+	private:
+		GLuint ubo;
 	};
 
 	// @class RenderObject
 	// @brief Virtual class to represent any object that can be rendered to the screen.
 	class RenderObject {
 	public:
+		virtual ~RenderObject() = default;
+
 		virtual void render(const RenderingContext& ctx) = 0;
 		virtual bool inFrustum(const RenderingContext& ctx) = 0;
+
+		// @brief Writes the world space box around everything render() draws,
+		//		@min > @max if there is nothing to draw. The Renderer reads it on
+		//		attatchObject() and updateBounds().
+		// @returns false for objects that are never culled.
+		virtual bool getBounds(glm::vec3&, glm::vec3&) const {
+			return false;
+		}
+
+		// @brief Asked for every object that passes frustum culling, true skips
+		//		it this frame because something else hides it.
+		virtual bool isOccluded(const RenderingContext&) const {
+			return false;
+		}
+	};
+
+	// index type of the quad index buffer, 16 bits are enough for the default chunk size.
+	using QuadIndex = std::conditional_t<(MAXCHUNKQUADS * 4 <= 65536), GLushort, GLuint>;
+
+	constexpr const GLenum QUADINDEXTYPE = sizeof(QuadIndex) == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	// @class QuadIndexBuffer
+	// @brief Element buffer shared by every VAO that stores quads as 4 vertices.
+	//		Holds the indices (0, 1, 2, 0, 2, 3) + 4 * i for MAXCHUNKQUADS quads,
+	//		it is built once and never changes.
+	class QuadIndexBuffer {
+	private:
+		QuadIndexBuffer();
+
+	public:
+		// @brief creates the buffer on the first call, requires a current GL context.
+		static QuadIndexBuffer& getInstance();
+
+		// @brief binds the buffer to GL_ELEMENT_ARRAY_BUFFER, which also records
+		//		it in the currently bound VAO.
+		void bind() const {
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+		}
+
+	private:
+		GLuint ebo;
 	};
 
 	/*
@@ -48,9 +135,9 @@ namespace rendering {
 		bool firstWrite;
 
 		MultipleBufferVAO()
-			:vboDataOffset{ 0 },
+			:vbos{},
 			verticesN{ 0 },
-			vbos{},
+			vboDataOffset{ 0 },
 			firstWrite{ true } {
 			glGenVertexArrays(1, &this->vao);
 		}
@@ -68,6 +155,7 @@ namespace rendering {
 
 		void clear() {
 			glDeleteBuffers(vbos.size(), this->vbos.data());
+			this->vbos.clear();
 		}
 
 		// @brief Copies the data of a vertex attribute into the VBO,
@@ -108,10 +196,92 @@ namespace rendering {
 		}
 	};
 
+	/*
+	* @struct InterleavedVAO
+	* @brief VAO with a single interleaved VBO that is reused every time the data
+	* changes. The VBO grows when the new data doesn't fit, is orphaned and
+	* rewritten in place when it does and shrinks when most of it is unused,
+	* so re-uploading never creates new buffers.
+	*/
+	struct InterleavedVAO {
+		GLuint vao;
+		GLuint vbo;
+
+		// bytes allocated for the VBO.
+		GLsizeiptr capacity;
+
+		GLsizeiptr verticesN;
+
+		// amount of indices drawn when the VAO uses the quad index buffer.
+		GLsizei elementsN;
+
+		bool indexed;
+
+		InterleavedVAO()
+			:capacity{ 0 },
+			verticesN{ 0 },
+			elementsN{ 0 },
+			indexed{ false } {
+			glGenVertexArrays(1, &this->vao);
+			glGenBuffers(1, &this->vbo);
+		}
+
+		~InterleavedVAO() {
+			glDeleteVertexArrays(1, &this->vao);
+			glDeleteBuffers(1, &this->vbo);
+		}
+
+		InterleavedVAO(const InterleavedVAO&) = delete;
+		InterleavedVAO& operator=(const InterleavedVAO&) = delete;
+
+		InterleavedVAO& use() {
+			glBindVertexArray(this->vao);
+			return *this;
+		}
+
+		// @brief Describes a float attribute of the interleaved vertex.
+		// @warning ALWAYS call use() before calling this function.
+		// @param offset offset in bytes of the attribute inside the vertex.
+		InterleavedVAO& setAttribute(GLuint attribId, GLuint attribSize, GLsizei stride, size_t offset, GLboolean normalize = GL_FALSE);
+
+		// @brief Describes an unsigned integer attribute of the interleaved vertex,
+		//		read as an integer by the shader.
+		// @warning ALWAYS call use() before calling this function.
+		InterleavedVAO& setIntegerAttribute(GLuint attribId, GLuint attribSize, GLsizei stride, size_t offset);
+
+		// @brief Draws the vertices as quads of 4 vertices through the shared
+		//		QuadIndexBuffer instead of as a list of triangles. Affects the
+		//		data passed to upload() after the call.
+		// @warning ALWAYS call use() before calling this function.
+		InterleavedVAO& useQuadIndices() {
+			QuadIndexBuffer::getInstance().bind();
+			this->indexed = true;
+			return *this;
+		}
+
+		// @brief Replaces the contents of the VBO with @bytes bytes of @data.
+		// @param vertices amount of vertices in @data.
+		InterleavedVAO& upload(const void* data, GLsizeiptr bytes, GLsizeiptr vertices);
+
+		void draw() const {
+			glBindVertexArray(this->vao);
+			if (this->indexed)
+				glDrawElements(GL_TRIANGLES, this->elementsN, QUADINDEXTYPE, (GLvoid*)0);
+			else
+				glDrawArrays(GL_TRIANGLES, 0, this->verticesN);
+		}
+	};
+
 	class Renderer {
 	public:
 		Renderer()
-		:objects{}
+		:objects{},
+		bounds{},
+		hierarchy{},
+		slots{},
+		visible{},
+		sorter{},
+		drawOrder{}
 		{
 
 		};
@@ -119,9 +289,36 @@ namespace rendering {
 
 	public:
 		Renderer& attatchObject(RenderObject* obj);
+		Renderer& detachObject(RenderObject* obj);
+
+		// @brief Reads the bounds of @obj again, call it when they change.
+		void updateBounds(RenderObject* obj);
+
+		// @brief Culls the objects against ctx.frustum, regions and chunk columns
+		//		first, and renders the visible ones nearest to the camera first so
+		//		the depth test rejects the fragments of the ones behind.
 		void render(const RenderingContext& ctx);
 
+		// @brief Objects drawn by the last render(), front to back. Walk it
+		//		backwards for passes that need back to front order (e.g. blending).
+		const std::vector<RenderObject*>& getDrawOrder() const {
+			return this->drawOrder;
+		}
+
 	private:
+		void readBounds(uint32_t slot);
+
+	private:
+		// objects[i] is culled with bounds box i.
 		std::vector<RenderObject*> objects;
+		culling::BoxArray bounds;
+		culling::BoxHierarchy hierarchy;
+		std::unordered_map<RenderObject*, uint32_t> slots;
+
+		// filled every frame with the slots that passed culling, sorted by distance.
+		std::vector<uint32_t> visible;
+		culling::DistanceSorter sorter;
+
+		std::vector<RenderObject*> drawOrder;
 	};
 };
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "ShaderCreation.hpp"
+#include "TextureLoader.h"
+#include "Rendering.hpp"
+
+namespace dlb {
+
+	// @class ResourceCache
+	// @brief Owns the shader programs and textures shared between objects. Every
+	//		resource is loaded the first time it is requested and the same handle is
+	//		returned afterwards. Handles stay valid for the whole program.
+	class ResourceCache {
+	private:
+		ResourceCache() = default;
+		~ResourceCache() = default;
+
+	public:
+		ResourceCache(const ResourceCache&) = delete;
+		ResourceCache& operator=(const ResourceCache&) = delete;
+
+		// @warning the first call to any getter must happen with a current GL context.
+		static ResourceCache& getInstance() {
+			static ResourceCache instance{};
+			return instance;
+		}
+
+	public:
+		// @brief Returns the program linked from the given vertex and fragment shader
+		//		files, compiling it on the first request. Its FrameUniforms block, if
+		//		any, is bound to FRAMEUNIFORMSBINDING once at that point.
+		ShaderProgram* getShader(const std::string& vertexPath, const std::string& fragmentPath) {
+			const auto key = vertexPath + '|' + fragmentPath;
+
+			auto it = this->shaders.find(key);
+			if (it != this->shaders.end())
+				return it->second.get();
+
+			ShaderProgramBuilder builder{};
+			auto program = std::make_unique<ShaderProgram>(
+				builder
+				.shaderFromFile(vertexPath.c_str())
+				.fragmentFromFile(fragmentPath.c_str())
+				.build());
+
+			program->bindUniformBlock(rendering::FRAMEUNIFORMSBLOCK, rendering::FRAMEUNIFORMSBINDING);
+
+			return this->shaders.emplace(key, std::move(program)).first->second.get();
+		}
+
+		// @brief Returns a texture loader holding only the texture at @filePath,
+		//		decoding and uploading it on the first request.
+		TextureLoader* getTexture(const std::string& filePath) {
+			auto it = this->textures.find(filePath);
+			if (it != this->textures.end())
+				return it->second.get();
+
+			auto texture = std::make_unique<TextureLoader>();
+			texture->loadTexture(filePath);
+
+			return this->textures.emplace(filePath, std::move(texture)).first->second.get();
+		}
+
+	private:
+		// keyed by "vertexPath|fragmentPath".
+		std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> shaders;
+		std::unordered_map<std::string, std::unique_ptr<TextureLoader>> textures;
+	};
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
 #include <tuple>
 #include <string_view>
 #include <fstream>
@@ -16,14 +19,28 @@ namespace dlb {
 
 	using uint = unsigned int;
 
+	// @struct UniformLocation
+	// @brief Location of an active uniform of a ShaderProgram, resolved once with
+	//		ShaderProgram::getUniformLocation() so setting it costs no lookup.
+	//		-1 if the program has no such uniform, setting it is then a no-op.
+	struct UniformLocation {
+		GLint location = -1;
+
+		bool isValid() const {
+			return this->location != -1;
+		}
+	};
+
 	class ShaderProgram {
 	public:
 
 		ShaderProgram() = default;
 		~ShaderProgram() = default;
 
+		// @brief Wraps a linked program and caches the locations of all its active uniforms.
 		ShaderProgram(uint id) {
 			this->shaderProgramId = id;
+			this->reflectUniforms();
 		}
 
 		ShaderProgram(const ShaderProgram& rhs) = default;
@@ -39,38 +56,96 @@ namespace dlb {
 
 		uint getProgramId() { return this->shaderProgramId; }
 
+		// @brief Looks the location up in the cache built at link time. Names that
+		//		reflection doesn't list (e.g. "lights[1]") are queried once from the
+		//		driver and cached, missing uniforms included.
+		UniformLocation getUniformLocation(const std::string& uniformName) const {
+			auto it = this->uniformLocations.find(uniformName);
+			if (it == this->uniformLocations.end())
+				it = this->uniformLocations.emplace(uniformName, glGetUniformLocation(this->shaderProgramId, uniformName.c_str())).first;
+			return UniformLocation{ it->second };
+		}
+
 		void setUniform(const std::string& uniformName, int x) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniform1i(loc, x);
+			this->setUniform(this->getUniformLocation(uniformName), x);
 		}
 
 		void setUniform1f(const std::string& uniformName, float x) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniform1f(loc, x);
+			glUniform1f(this->getUniformLocation(uniformName).location, x);
 		}
 
 		void setUniform2f(const std::string& uniformName, float x, float y) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniform2f(loc, x, y);
+			glUniform2f(this->getUniformLocation(uniformName).location, x, y);
 		}
 
 		void setUniform4f(const std::string& uniformName, float x1, float x2, float x3, float x4) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniform4f(loc, x1, x2, x3, x4);
+			glUniform4f(this->getUniformLocation(uniformName).location, x1, x2, x3, x4);
 		}
 
 		void setUniform(const std::string& uniformName, const glm::vec3& o) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniform3f(loc, o.x, o.y, o.z);
+			this->setUniform(this->getUniformLocation(uniformName), o);
 		}
 		
-		void setUniform(const std::string& uniformName, glm::mat4& mat4) {
-			const auto loc = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
-			glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mat4));
+		void setUniform(const std::string& uniformName, const glm::mat4& mat4) {
+			this->setUniform(this->getUniformLocation(uniformName), mat4);
 		}
-		
+
+		void setUniform(UniformLocation uniform, int x) {
+			glUniform1i(uniform.location, x);
+		}
+
+		void setUniform(UniformLocation uniform, const glm::vec3& o) {
+			glUniform3f(uniform.location, o.x, o.y, o.z);
+		}
+
+		void setUniform(UniformLocation uniform, const glm::mat4& mat4) {
+			glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(mat4));
+		}
+
+		// @brief Makes the uniform block @blockName read from @bindingPoint. Does
+		//		nothing if the program has no such block.
+		void bindUniformBlock(const std::string& blockName, GLuint bindingPoint) {
+			const auto blockIndex = glGetUniformBlockIndex(this->shaderProgramId, blockName.c_str());
+			if (blockIndex != GL_INVALID_INDEX)
+				glUniformBlockBinding(this->shaderProgramId, blockIndex, bindingPoint);
+		}
+
+	private:
+		void reflectUniforms() {
+			GLint count = 0;
+			glGetProgramiv(this->shaderProgramId, GL_ACTIVE_UNIFORMS, &count);
+
+			GLint maxLength = 0;
+			glGetProgramiv(this->shaderProgramId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+			std::vector<char> name(std::max(maxLength, 1));
+
+			for (GLint i = 0; i < count; i++) {
+				GLsizei length = 0;
+				GLint size = 0;
+				GLenum type = 0;
+				glGetActiveUniform(this->shaderProgramId, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+				std::string uniformName(name.data(), length);
+				const auto location = glGetUniformLocation(this->shaderProgramId, uniformName.c_str());
+
+				// uniforms in blocks have no location.
+				if (location == -1)
+					continue;
+
+				this->uniformLocations[uniformName] = location;
+
+				// arrays are reported as "name[0]", make them reachable as "name" too.
+				const auto arraySuffix = uniformName.rfind("[0]");
+				if (arraySuffix != std::string::npos && arraySuffix + 3 == uniformName.length())
+					this->uniformLocations[uniformName.substr(0, arraySuffix)] = location;
+			}
+		}
+
 	private:
 		uint shaderProgramId;
+		// filled by reflectUniforms() and grown by getUniformLocation() on misses.
+		mutable std::unordered_map<std::string, GLint> uniformLocations;
 	};
 
 	class ShaderProgramBuilder {
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+#include "Config.hpp"
+#include "VoxelStorage.hpp"
+
+namespace terrain {
+	// voxels at or below this height are carved by the 3D cave noise.
+	constexpr const int CAVELEVEL = 36;
+
+	// the surface height is SURFACELEVEL + noise * SURFACEAMPLITUDE.
+	constexpr const float SURFACELEVEL = 40.0f;
+	constexpr const float SURFACEAMPLITUDE = 8.0f;
+
+	constexpr const float FREQUENCY = 0.05f;
+
+	// distance (in voxels) between the samples of the cave density lattice.
+	constexpr const int DENSITYSTEP = 4;
+	constexpr const int LATTICESIZE = CHUNKSIZE / DENSITYSTEP + 1;
+
+	static_assert(CHUNKSIZE % DENSITYSTEP == 0, "the density lattice must line up with the chunk borders");
+
+	// ground voxels take ids 1..Grass - 1 from their world y + world z (see
+	// groundId()), the other materials use fixed ids above them.
+	enum Material : VoxelId {
+		Air = 0,
+		Grass = 2040,
+		Dirt,
+		Wood,
+		Leaves,
+	};
+
+	// @brief Id of a ground voxel, world y + world z wrapped into 1..Grass - 1 so
+	//		it is never Air nor another material, whatever the sign of the sum.
+	//		Sums already in that range keep their value.
+	constexpr VoxelId groundId(int worldY, int worldZ) {
+		constexpr int range = Grass - 1;
+		const int wrapped = (worldY + worldZ - 1) % range;
+		return static_cast<VoxelId>(1 + (wrapped < 0 ? wrapped + range : wrapped));
+	}
+
+	static_assert(groundId(0, 0) == Grass - 1 && groundId(40, -39) == 1 && groundId(0, -2038) == 1 && groundId(-1, 0) == Grass - 2,
+		"ground ids must stay clear of the other materials");
+
+	// layers of dirt under the grass.
+	constexpr const int DIRTDEPTH = 3;
+
+	// one column in TREECHANCE grows a tree, trees reach TREERADIUS voxels
+	// away from their trunk.
+	constexpr const uint32_t TREECHANCE = 64;
+	constexpr const int TREERADIUS = 2;
+	constexpr const int MINTRUNKHEIGHT = 4;
+
+	// @brief Generation stages, in the order they run. A chunk stores the last
+	//		stage it completed.
+	enum class Stage {
+		None,			// nothing generated yet.
+		BaseDensity,	// heightmap, ground under the surface and everything under the cave level.
+		Surface,		// grass and dirt on top of the ground.
+		Caves,			// caves carved under the cave level.
+		Decoration,		// trees, they may cross into the neighbouring chunks.
+	};
+
+	constexpr const Stage LASTSTAGE = Stage::Decoration;
+
+	constexpr Stage nextStage(Stage stage) {
+		return static_cast<Stage>(static_cast<int>(stage) + 1);
+	}
+
+	// @brief true if @stage reads the heightmaps of the 8 chunks around the chunk
+	//		on the XZ plane. It can only run once they completed the previous stage.
+	constexpr bool needsNeighbours(Stage stage) {
+		return stage == Stage::Decoration;
+	}
+
+	// @struct Heightmap
+	// @brief Surface height of every (x, z) column of a chunk, indexed as [x * CHUNKSIZE + z].
+	struct Heightmap {
+		std::array<float, CHUNKSIZE * CHUNKSIZE> heights;
+
+		float at(int x, int z) const {
+			return heights[x * CHUNKSIZE + z];
+		}
+	};
+
+	// @struct DensityLattice
+	// @brief Cave noise sampled every DENSITYSTEP voxels, corners included, so
+	//		neighbouring chunks share the samples on their common border.
+	//		Indexed as [(x * LATTICESIZE + y) * LATTICESIZE + z].
+	struct DensityLattice {
+		std::array<float, LATTICESIZE * LATTICESIZE * LATTICESIZE> samples;
+
+		float at(int x, int y, int z) const {
+			return samples[(x * LATTICESIZE + y) * LATTICESIZE + z];
+		}
+
+		// @brief Trilinear interpolation of the samples at the chunk relative voxel (x, y, z).
+		float interpolate(int x, int y, int z) const;
+	};
+
+	// @struct HeightmapNeighbourhood
+	// @brief Heightmaps of a chunk and of its 8 neighbours on the XZ plane,
+	//		indexed as [(dx + 1) * 3 + (dz + 1)].
+	struct HeightmapNeighbourhood {
+		std::array<Heightmap, 9> maps;
+
+		// @param x, z chunk relative coordinates in the range -CHUNKSIZE..2 * CHUNKSIZE - 1
+		float at(int x, int z) const;
+	};
+
+	// @brief Evaluates the surface noise once per column of the chunk at @chunkCoord.
+	void computeHeightmap(const glm::ivec3& chunkCoord, Heightmap& out);
+
+	// @brief Samples the cave noise on the lattice of the chunk at @chunkCoord.
+	void sampleDensity(const glm::ivec3& chunkCoord, DensityLattice& out);
+
+	// Every stage only writes the voxels of its own chunk, so the stages of
+	// different chunks can run in parallel.
+
+	// @brief Replaces the voxels of @out with the ground of the chunk at @chunkCoord.
+	// @param heightmap receives the surface heights of the chunk.
+	void generateBaseDensity(const glm::ivec3& chunkCoord, VoxelStorage& out, Heightmap& heightmap);
+
+	// @brief Covers the ground with grass and dirt.
+	void generateSurface(const glm::ivec3& chunkCoord, VoxelStorage& voxels, const Heightmap& heightmap);
+
+	// @brief Carves the caves out of the ground under the cave level.
+	void carveCaves(const glm::ivec3& chunkCoord, VoxelStorage& voxels);
+
+	// @brief Grows the parts of the trees that fall inside the chunk, including
+	//		the ones of trees rooted in the neighbouring chunks. Trees are placed
+	//		with a hash of their column, so every chunk agrees on where they are.
+	void decorate(const glm::ivec3& chunkCoord, VoxelStorage& voxels, const HeightmapNeighbourhood& heightmaps);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// @class ThreadPool
+// @brief Fixed set of worker threads running jobs in submission order.
+class ThreadPool {
+public:
+	// @param threadCount amount of workers, at least one is always created.
+	ThreadPool(unsigned int threadCount);
+
+	// @brief Jobs still in the queue are discarded, running ones are waited for.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+	void submit(std::function<void()> job);
+
+	// @brief Discards the jobs that haven't started yet.
+	void cancelPending();
+
+	// @brief Blocks until every submitted job has finished.
+	void waitIdle();
+
+	unsigned int size() const {
+		return static_cast<unsigned int>(this->workers.size());
+	}
+
+	// @brief Amount of workers that leaves one core to the render thread.
+	static unsigned int defaultThreadCount();
+
+	// @brief Workers of one of @pools pools busy at the same time, so that
+	//		together they stay within defaultThreadCount(). At least one.
+	static unsigned int sharedThreadCount(unsigned int pools);
+
+private:
+	void workerLoop();
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobsDone;
+
+	// jobs taken from the queue that are still running.
+	unsigned int running;
+
+	bool stopping;
+};
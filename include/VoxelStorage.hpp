@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#include "Config.hpp"
+
+// id of a block type, 0 is air.
+using VoxelId = uint16_t;
+
+// @class VoxelStorage
+// @brief Palette compressed voxels of a chunk. Every voxel stores an index into
+//		a palette of the distinct ids written to the chunk, packed with the fewest
+//		bits (1, 2, 4, 8 or 16) that can index the palette. A chunk holding a single
+//		id (e.g. all air or all stone) stores no voxel data at all.
+//		Voxels are ordered as [x][y][z], like the old Voxel3DArray.
+class VoxelStorage {
+public:
+	// @brief Creates a chunk where every voxel is @id.
+	VoxelStorage(VoxelId id = 0);
+	~VoxelStorage() = default;
+
+public:
+	VoxelId get(int x, int y, int z) const {
+		if (this->bitsPerVoxel == 0)
+			return this->palette[0];
+
+		const auto index = voxelIndex(x, y, z);
+		const auto word = this->words[index / this->voxelsPerWord];
+		const auto shift = (index % this->voxelsPerWord) * this->bitsPerVoxel;
+
+		return this->palette[(word >> shift) & this->indexMask];
+	}
+
+	// @brief Writes @id, adding it to the palette (and widening the packed
+	//		indices if needed) when the chunk doesn't contain it yet.
+	void set(int x, int y, int z, VoxelId id);
+
+	// @brief Sets every voxel to @id, going back to the single value mode.
+	void fill(VoxelId id);
+
+	// @brief Replaces the whole chunk with the CHUNKVOLUME voxels in @voxels,
+	//		ordered as [x][y][z]. Builds the palette and packs the voxels once,
+	//		much cheaper than calling set() for every voxel.
+	void assign(const VoxelId* voxels);
+
+	// @brief Decodes the CHUNKSIZE voxels at (x, y, 0..CHUNKSIZE - 1) into @out.
+	void getRow(int x, int y, VoxelId* out) const;
+
+	// @brief true if every voxel holds the same id (no voxel data is stored).
+	bool isUniform() const {
+		return this->bitsPerVoxel == 0;
+	}
+
+	// @brief Only meaningful if isUniform().
+	VoxelId uniformValue() const {
+		return this->palette[0];
+	}
+
+	// @brief false if no voxel holds @id. The palette isn't trimmed when ids are
+	//		overwritten, so true only means @id may still be in the chunk.
+	bool mayContain(VoxelId id) const {
+		return std::find(this->palette.begin(), this->palette.end(), id) != this->palette.end();
+	}
+
+	int getBitsPerVoxel() const {
+		return this->bitsPerVoxel;
+	}
+
+	size_t getPaletteSize() const {
+		return this->palette.size();
+	}
+
+	// @brief Bytes used by the palette and the packed voxels.
+	size_t memoryUsage() const {
+		return this->palette.capacity() * sizeof(VoxelId) + this->words.capacity() * sizeof(uint64_t);
+	}
+
+private:
+	static int voxelIndex(int x, int y, int z) {
+		return (x * CHUNKSIZE + y) * CHUNKSIZE + z;
+	}
+
+	// @brief Repacks the voxels using @bits bits per palette index.
+	void repack(int bits);
+
+	void setIndex(int index, uint64_t paletteIndex) {
+		auto& word = this->words[index / this->voxelsPerWord];
+		const auto shift = (index % this->voxelsPerWord) * this->bitsPerVoxel;
+
+		word = (word & ~(this->indexMask << shift)) | (paletteIndex << shift);
+	}
+
+private:
+	std::vector<VoxelId> palette;
+	std::vector<uint64_t> words;
+
+	int bitsPerVoxel;
+	int voxelsPerWord;
+	uint64_t indexMask;
+};
@@ -7,9 +7,13 @@ in vec3 vertexColor;
 
 out vec4 FragColor; // output a color to the fragment shader
 
-uniform vec3 lightPosition;
-uniform vec3 lightColor;
-uniform vec3 viewPos;
+// filled once per frame by rendering::FrameUniformBuffer
+layout (std140) uniform FrameUniforms {
+    mat4 projectionView;
+    vec4 lightPosition;
+    vec4 lightColor;
+    vec4 viewPosition;
+};
 
 void main()
 {
@@ -19,20 +23,20 @@ void main()
     //vec3 texColor = vec3(0.0f, 1.0f, 0.0f);
 
     float ambientStrength = 0.1;
-    vec3 ambient = ambientStrength * lightColor;
+    vec3 ambient = ambientStrength * lightColor.xyz;
     vec3 objectColor = vec3(0.20, 0.88, 0.24);
 
     vec3 norm = normalize(normal);
-    vec3 lightDir = normalize(lightPosition - fragPos);
+    vec3 lightDir = normalize(lightPosition.xyz - fragPos);
     float diffuse = max(dot(norm, lightDir), 0.0f);
-    vec3 diffuseLight = diffuse * lightColor;
+    vec3 diffuseLight = diffuse * lightColor.xyz;
 
     float specularStrength = 1.0f;
-    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 viewDir = normalize(viewPosition.xyz - fragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
 
     float spec = pow(max(dot(viewDir, reflectDir), 0.0f), 128);
-    vec3 specular = specularStrength * spec * lightColor;
+    vec3 specular = specularStrength * spec * lightColor.xyz;
 
     vec3 result = (ambient + diffuseLight + specular) * vertexColor.xyz;
 
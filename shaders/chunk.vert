@@ -1,18 +1,34 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPosition;
-layout (location = 1) in vec3 aNormal;
-//layout (location = 2) in vec2 aTexCoords;
-layout (location = 2) in float aVoxelId;
+// x: bits 0-5, y: bits 6-11, z: bits 12-17, face: bits 18-20, voxel id: bits 21-31
+layout (location = 0) in uint aPackedVertex;
 
-uniform mat4 MVP;
-uniform mat4 modelMatrix;
+// filled once per frame by rendering::FrameUniformBuffer
+layout (std140) uniform FrameUniforms {
+    mat4 projectionView;
+    vec4 lightPosition;
+    vec4 lightColor;
+    vec4 viewPosition;
+};
+
+// world position of the chunk's (0, 0, 0) voxel
+uniform vec3 chunkOffset;
 
 out vec3 normal;
 out vec3 fragPos;
 //out vec2 texCoords;
 out vec3 vertexColor;
 
+// indexed by face: -X, +X, -Y, +Y, -Z, +Z
+const vec3 faceNormals[6] = vec3[6](
+    vec3(-1.0f, 0.0f, 0.0f),
+    vec3(1.0f, 0.0f, 0.0f),
+    vec3(0.0f, -1.0f, 0.0f),
+    vec3(0.0f, 1.0f, 0.0f),
+    vec3(0.0f, 0.0f, -1.0f),
+    vec3(0.0f, 0.0f, 1.0f)
+);
+
 vec3 hash31(float p) {
     vec3 p3 = fract(vec3(p * 21.2) * vec3(0.1031, 0.1030, 0.0973));
     p3 += dot(p3, p3.yzx + 33.33);
@@ -20,9 +36,17 @@ vec3 hash31(float p) {
 }
 
 void main() {
-    gl_Position = MVP * vec4(aPosition, 1.0f);
-    fragPos = vec3(modelMatrix * vec4(aPosition, 1.0f));
-    normal = mat3(transpose(inverse(modelMatrix))) * aNormal;
+    vec3 position = vec3(
+        float(aPackedVertex & 63u),
+        float((aPackedVertex >> 6u) & 63u),
+        float((aPackedVertex >> 12u) & 63u));
+    uint face = (aPackedVertex >> 18u) & 7u;
+    float voxelId = float(aPackedVertex >> 21u);
+
+    fragPos = position + chunkOffset;
+    gl_Position = projectionView * vec4(fragPos, 1.0f);
+    // chunks are only translated, normals don't change.
+    normal = faceNormals[face];
 	//texCoords = aTexCoords;
-    vertexColor = hash31(aVoxelId);
+    vertexColor = hash31(voxelId);
 }
@@ -2,11 +2,19 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
-uniform mat4 MVP;
+// filled once per frame by rendering::FrameUniformBuffer
+layout (std140) uniform FrameUniforms {
+    mat4 projectionView;
+    vec4 lightPosition;
+    vec4 lightColor;
+    vec4 viewPosition;
+};
+
+uniform mat4 modelMatrix;
 out vec2 texCoord;
 
 void main()
 {
-	gl_Position = MVP * vec4(aPos, 1.0);
+	gl_Position = projectionView * modelMatrix * vec4(aPos, 1.0);
 	texCoord = aTexCoord;
 }
\ No newline at end of file
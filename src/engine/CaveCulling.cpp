@@ -0,0 +1,90 @@
+#include <glm/common.hpp>
+
+#include "CaveCulling.hpp"
+#include "ChunkMesh2.hpp"
+#include "ChunkMesher.hpp"
+#include "Frustum.hpp"
+
+// offset of the neighbour across each meshing::Face.
+static const glm::ivec3 FACEOFFSETS[meshing::FaceCount] = {
+	{ -1, 0, 0 }, { 1, 0, 0 },
+	{ 0, -1, 0 }, { 0, 1, 0 },
+	{ 0, 0, -1 }, { 0, 0, 1 },
+};
+
+// faces come in pairs, the opposite of a face is its pair.
+static int oppositeFace(int face) {
+	return face ^ 1;
+}
+
+CaveCuller::CaveCuller()
+	:queue{},
+	stamp{ 0 },
+	active{ false },
+	enabled{ true },
+	reached{ 0 } {
+}
+
+void CaveCuller::update(const rendering::RenderingContext& ctx) {
+	this->stamp++;
+	this->active = false;
+	this->reached = 0;
+
+	if (!this->enabled)
+		return;
+
+	const auto cameraCoord = glm::ivec3(glm::floor(ctx.camera.getPosition() / (float)CHUNKSIZE));
+	auto start = ctx.world->find(cameraCoord);
+
+	// above or below the loaded world there is nothing to walk from.
+	if (!start)
+		return;
+
+	this->active = true;
+	this->queue.clear();
+
+	(*start)->setVisitStamp(this->stamp);
+	this->queue.push_back(Step{ *start, cameraCoord, -1, 0 });
+
+	for (size_t head = 0; head < this->queue.size(); head++) {
+		// copy, enter() may grow the queue.
+		const auto step = this->queue[head];
+		const auto connectivity = step.chunk->getConnectivity();
+
+		for (int face = 0; face < meshing::FaceCount; face++) {
+			if (face == step.entry)
+				continue;
+
+			// never go back towards a direction the walk came from.
+			if (step.directions & (1u << oppositeFace(face)))
+				continue;
+
+			if (step.entry >= 0 && !meshing::facesConnected(connectivity, step.entry, face))
+				continue;
+
+			this->enter(ctx, step, face);
+		}
+	}
+
+	this->reached = this->queue.size();
+}
+
+void CaveCuller::enter(const rendering::RenderingContext& ctx, const Step& from, int face) {
+	const auto coord = from.coord + FACEOFFSETS[face];
+	auto neighbour = ctx.world->find(coord);
+
+	// the walk ends at the edge of the loaded world.
+	if (!neighbour || (*neighbour)->getVisitStamp() == this->stamp)
+		return;
+
+	const auto min = glm::vec3(coord * CHUNKSIZE);
+	if (!ctx.frustum->aabbIn(min, min + (float)CHUNKSIZE))
+		return;
+
+	(*neighbour)->setVisitStamp(this->stamp);
+	this->queue.push_back(Step{ *neighbour, coord, oppositeFace(face), from.directions | (1u << face) });
+}
+
+bool CaveCuller::isReachable(const ChunkMesh2& chunk) const {
+	return !this->active || chunk.getVisitStamp() == this->stamp;
+}
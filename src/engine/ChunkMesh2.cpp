@@ -2,13 +2,16 @@
 #include <algorithm>
 
 #include <glm/matrix.hpp>
-#include <glm/gtc/noise.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "LightSource.hpp"
 #include "ChunkMesh2.hpp"
 #include "Printing.hpp"
 #include "Frustum.hpp"
+#include "ResourceCache.hpp"
+#include "TerrainGenerator.hpp"
+#include "CaveCulling.hpp"
+#include "OcclusionCulling.hpp"
 
 static void checkGLError(const char* functionName) {
 	GLenum error;
@@ -43,316 +46,179 @@ ChunkMesh2::ChunkMesh2(const glm::vec3& startPos)
 	shaderProgram{},
 	textureLoader{},
 	voxels{},
-	id{} {
+	id{},
+	stage{ terrain::Stage::None },
+	stageRunning{ false },
+	contents{ Contents::Mixed },
+	solidLayers{ 0 },
+	boundsMin{ 0.0f },
+	boundsMax{ 0.0f },
+	connectivity{ meshing::ALLFACESCONNECTED },
+	visitStamp{ 0 } {
 
 	this->startPosition = startPos;
 
-	dlb::ShaderProgramBuilder shaderProgramBuilder{};
-	this->shaderProgram = std::move(
-		shaderProgramBuilder
-		.shaderFromFile(SHADERSDIR "/chunk.vert")
-		.fragmentFromFile(SHADERSDIR "/chunk.frag")
-		.build());
+	// shared by every chunk, only the first chunk loads them.
+	auto& resources = dlb::ResourceCache::getInstance();
+	this->shaderProgram = resources.getShader(SHADERSDIR "/chunk.vert", SHADERSDIR "/chunk.frag");
+	this->textureLoader = resources.getTexture(TEXTUREDIR "container.jpg");
 
-	this->textureLoader
-		.loadTexture(TEXTUREDIR "container.jpg");
-}
-
-static constexpr const int caveY = 36;
+	this->chunkOffsetUniform = this->shaderProgram->getUniformLocation("chunkOffset");
 
-static int generateTerrain(const glm::vec3& worldPos) {
+	// the layout never changes, re-meshing only replaces the VBO contents.
+	this->vao.use()
+		.setIntegerAttribute(0, 1, sizeof(meshing::PackedVertex), 0)
+		.useQuadIndices();
+}
 
-	if (worldPos.y <= caveY) {
-		auto noiseVal = glm::perlin(glm::vec3(worldPos.x, worldPos.y, worldPos.z) * 0.05f);
-		return noiseVal < 0 ? 0 : worldPos.y + worldPos.z;
+void ChunkMesh2::generateStage(terrain::Stage stage, const terrain::HeightmapNeighbourhood* heightmaps) {
+	const auto coord = this->getChunkCoord();
+
+	switch (stage) {
+	case terrain::Stage::BaseDensity:
+		terrain::generateBaseDensity(coord, this->voxels, this->heightmap);
+		break;
+	case terrain::Stage::Surface:
+		terrain::generateSurface(coord, this->voxels, this->heightmap);
+		break;
+	case terrain::Stage::Caves:
+		terrain::carveCaves(coord, this->voxels);
+		break;
+	case terrain::Stage::Decoration:
+		terrain::decorate(coord, this->voxels, *heightmaps);
+		break;
+	default:
+		break;
 	}
-	
-	auto surfaceY = 40 + glm::perlin(glm::vec2(worldPos.x, worldPos.z) * 0.05f) * 8;
-	return (worldPos.y < surfaceY) ? worldPos.y + worldPos.z : 0;
 }
 
-// PUT HERE THE TERRAIN GENERATION ALGORITHM
-void ChunkMesh2::generateChunk() {
+void ChunkMesh2::captureSnapshot(const rendering::RenderingContext& ctx, meshing::ChunkSnapshot& out) const {
+	meshing::beginSnapshot(this->voxels, out);
 
-	auto cx = this->startPosition.x * CHUNKSIZE;
-	auto cy = this->startPosition.y * CHUNKSIZE;
-	auto cz = this->startPosition.z * CHUNKSIZE;
+	const auto pos = this->getChunkCoord();
+
+	for (int dx = -1; dx <= 1; dx++) {
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dz = -1; dz <= 1; dz++) {
+				const glm::ivec3 offset{ dx, dy, dz };
+
+				if (offset == glm::ivec3(0))
+					continue;
 
-	for (int x = 0; x < CHUNKSIZE; x++) {
-		for (int z = 0; z < CHUNKSIZE; z++) {
-			for (int y = 0; y < CHUNKSIZE; y++) {
-				this->voxels[x][y][z] = generateTerrain(glm::vec3(cx + x, cy + y, cz + z));
+				// chunks that aren't loaded or generated are void, the border is
+				// already cleared.
+				auto neighbour = ctx.world->neighbour(pos, offset);
+				if (!neighbour || !(*neighbour)->isGenerated())
+					continue;
+
+				meshing::copyBorder(offset, (*neighbour)->getVoxels(), out);
 			}
 		}
 	}
 }
 
-#define IN_RANGE(v, l, h) (v >= l && v < h)
+void ChunkMesh2::classify() {
+	if (this->voxels.isUniform() && this->voxels.uniformValue() == terrain::Air)
+		this->contents = Contents::Empty;
+	else if (!this->voxels.mayContain(terrain::Air))
+		this->contents = Contents::Solid;
+	else
+		this->contents = Contents::Mixed;
 
-static bool isVoid(const glm::vec3& chunkRelPos, const glm::vec3& worldPos, const rendering::RenderingContext& ctx) {
+	if (this->contents != Contents::Mixed) {
+		this->solidLayers = this->contents == Contents::Solid ? CHUNKSIZE : 0;
+		return;
+	}
 
-	//std::cout << chunkRelPos << " " << worldPos << '\n';
+	std::array<VoxelId, CHUNKSIZE> row;
 
-	auto wx = (worldPos.x / (float)CHUNKSIZE);
-	auto wy = (worldPos.y / (float)CHUNKSIZE);
-	auto wz = (worldPos.z / (float)CHUNKSIZE);
+	for (this->solidLayers = 0; this->solidLayers < CHUNKSIZE; this->solidLayers++) {
+		for (int x = 0; x < CHUNKSIZE; x++) {
+			this->voxels.getRow(x, this->solidLayers, row.data());
+			if (std::find(row.begin(), row.end(), terrain::Air) != row.end())
+				return;
+		}
+	}
+}
 
-	auto cx = (CHUNKSIZE * (chunkRelPos.x == -1)) + (int)chunkRelPos.x % CHUNKSIZE;
-	auto cy = (CHUNKSIZE * (chunkRelPos.y == -1)) + (int)chunkRelPos.y % CHUNKSIZE; // always transform Y to negative because of some shit with the camera.
-	auto cz = (CHUNKSIZE * (chunkRelPos.z == -1)) + (int)chunkRelPos.z % CHUNKSIZE;
+bool ChunkMesh2::isBuried(const rendering::RenderingContext& ctx) const {
+	if (this->contents != Contents::Solid)
+		return false;
 
-	// coordinates are outside of the world, thus chunk doesn't exists (void)
-	if (wy < 0 || wy >= WORLDSIZE || wx < 0 || wx >= WORLDSIZE || wz < 0 || wz >= WORLDSIZE)
-		return true;
+	const auto pos = this->getChunkCoord();
 
-	auto chunk = ctx.world->at(wx, wy, wz);
-	//if (IN_RANGE(cx, 0, CHUNKSIZE) && IN_RANGE(cy, 0, CHUNKSIZE) && IN_RANGE(cz, 0, CHUNKSIZE))
-	if (chunk->getVoxels()[cx][cy][cz])
-		return false;
-	
-	return true;
-}
+	for (int face = 0; face < meshing::FaceCount; face++) {
+		glm::ivec3 offset{ 0 };
+		offset[face / 2] = (face % 2) ? 1 : -1;
 
-template<typename T>
-static void pushVertex(std::vector<T>& cont, T x, T y, T z) {
-	cont.push_back(x);
-	cont.push_back(y);
-	cont.push_back(z);
-}
+		// chunks that aren't loaded or generated are void.
+		auto neighbour = ctx.world->neighbour(pos, offset);
+		if (!neighbour || !(*neighbour)->isGenerated() || (*neighbour)->getContents() != Contents::Solid)
+			return false;
+	}
 
-template<typename T>
-static void pushVertex(std::vector<T>& cont, T x, T y) {
-	cont.push_back(x);
-	cont.push_back(y);
+	return true;
 }
 
-template<typename T>
-static void pushVertex(std::vector<T>& cont, T x) {
-	cont.push_back(x);
-}
+ChunkMesh2::MeshingMode ChunkMesh2::meshingMode = ChunkMesh2::MeshingMode::Greedy;
 
-static void pushNormals(std::vector<float>& ns, float x, float y, float z) {
-	pushVertex(ns, x, y, z);
-	pushVertex(ns, x, y, z);
-	pushVertex(ns, x, y, z);
-	pushVertex(ns, x, y, z);
-	pushVertex(ns, x, y, z);
-	pushVertex(ns, x, y, z);
-}
+void ChunkMesh2::uploadMesh(const meshing::MeshBuffers& mesh) {
+	const auto origin = this->startPosition * (float)CHUNKSIZE;
+	this->boundsMin = origin + glm::vec3(mesh.boundsMin);
+	this->boundsMax = origin + glm::vec3(mesh.boundsMax);
+	this->connectivity = mesh.connectivity;
 
-static void pushVoxelId(std::vector<float>& vs, float x) {
-	vs.push_back(x);
-	vs.push_back(x);
-	vs.push_back(x);
-	vs.push_back(x);
-	vs.push_back(x);
-	vs.push_back(x);
+	this->vao.use()
+		.upload(mesh.vertices.data(), mesh.vertices.size() * sizeof(meshing::PackedVertex), mesh.vertices.size());
 }
 
-void ChunkMesh2::generateMesh(const rendering::RenderingContext& ctx) {
+void ChunkMesh2::render([[maybe_unused]] const rendering::RenderingContext& ctx) {
 
-	if (!this->meshUpdate)
+	// not meshed yet or nothing visible in it.
+	if (this->vao.verticesN == 0)
 		return;
 
-	std::vector<float> meshPositionData;
-	std::vector<float> normals;
-	std::vector<float> textureCoords;
-	std::vector<float> voxelIds;
+	this->shaderProgram->use();
+	this->textureLoader->enableTextures();
 
-	
-	for (int a = 0; a < CHUNKSIZE; a++) {
-		for (int b = 0; b < CHUNKSIZE; b++) {
-			for (int c = 0; c < CHUNKSIZE; c++) {
-				auto voxel = (float)voxels[a][b][c];
-
-				// WORLD COORDINATES
-				auto x = static_cast<float>(a) + (this->startPosition.x * (float)CHUNKSIZE);
-				auto y = static_cast<float>(b) + (this->startPosition.y * (float)CHUNKSIZE);
-				auto z = static_cast<float>(c) + (this->startPosition.z * (float)CHUNKSIZE);
-
-				if (voxel == 0)
-					continue;
-
-				// top face
-				if (isVoid(glm::vec3(a, b + 1, c), glm::vec3(x, y + 1, z), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y + 1, z + 1);
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x, y + 1, z + 1);
-					pushVertex(meshPositionData, x + 1, y + 1, z + 1);
-
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, 0, 1, 0);
-				}
-
-				// bottom face
-				if (isVoid(glm::vec3(a, b - 1, c), glm::vec3(x, y - 1, z), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x, y, z);
-					pushVertex(meshPositionData, x + 1, y, z);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-					pushVertex(meshPositionData, x, y, z);
-					pushVertex(meshPositionData, x, y, z + 1);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, 0, -1, 0);
-				}
-
-				// left face
-				if (isVoid(glm::vec3(a - 1, b, c), glm::vec3(x - 1, y, z), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x, y, z);
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x, y, z + 1);
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x, y + 1, z + 1);
-					pushVertex(meshPositionData, x, y, z + 1);
-					
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, -1, 0, 0);
-				}
-
-				// right face
-				if (isVoid(glm::vec3(a + 1, b, c), glm::vec3(x + 1, y, z), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x + 1, y, z);
-					pushVertex(meshPositionData, x + 1, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-					pushVertex(meshPositionData, x + 1, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y + 1, z + 1);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, 1, 0, 0);
-				}
-
-				// front face
-				if (isVoid(glm::vec3(a, b, c - 1), glm::vec3(x, y, z - 1), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x, y, z);
-					pushVertex(meshPositionData, x + 1, y, z);
-					pushVertex(meshPositionData, x, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y + 1, z);
-					pushVertex(meshPositionData, x + 1, y, z);
-
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, 0, 0, 1);
-				}
-
-				// back face
-				if (isVoid(glm::vec3(a, b, c + 1), glm::vec3(x, y, z + 1), ctx)) {
-					pushVoxelId(voxelIds, voxel);
-
-					pushVertex(meshPositionData, x, y, z + 1);
-					pushVertex(meshPositionData, x, y + 1, z + 1);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-					pushVertex(meshPositionData, x + 1, y, z + 1);
-					pushVertex(meshPositionData, x + 1, y + 1, z + 1);
-					pushVertex(meshPositionData, x, y + 1, z + 1);
-
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 0.0f, 1.0f);
-					pushVertex(textureCoords, 1.0f, 1.0f);
-
-					pushNormals(normals, 0, 0, -1);
-				}
-			}
-		}
-	}
-
-	this->vao.use()
-		.addVertexAttribute(meshPositionData, 3, 0, GL_FALSE)
-		.addVertexAttribute(normals, 3, 1, GL_FALSE)
-		//.addVertexAttribute(textureCoords, 2, 2, GL_FALSE)
-		.addVertexAttribute(voxelIds, 1, 2, GL_FALSE);
+	// camera and light come from the frame uniform buffer, mesh vertices are
+	// relative to the chunk.
+	this->shaderProgram->setUniform(this->chunkOffsetUniform, this->startPosition * (float)CHUNKSIZE);
+	checkGLError(__FUNCTION__);
 
-	this->vao.verticesN = meshPositionData.size() / 3;
-	this->meshUpdate = false;
+	this->vao.draw();
 }
 
-void ChunkMesh2::render(const rendering::RenderingContext& ctx) {
-
-	this->generateMesh(ctx);
+bool ChunkMesh2::inFrustum(const rendering::RenderingContext& ctx) {
+	if (this->vao.verticesN == 0)
+		return false;
 
-	this->shaderProgram.use();
-	this->textureLoader.enableTextures();
+	return ctx.frustum->aabbIn(this->boundsMin, this->boundsMax);
+}
 
-	glm::mat4 model{ 1.0f };
+bool ChunkMesh2::getBounds(glm::vec3& min, glm::vec3& max) const {
+	if (this->vao.verticesN == 0) {
+		min = glm::vec3(1.0f);
+		max = glm::vec3(0.0f);
+		return true;
+	}
 
-	//model = glm::translate(model, this->startPosition);
-	   
-	auto MVP = ctx.camera.getProjectionMatrix() * ctx.camera.getViewMatrix() * model;
+	min = this->boundsMin;
+	max = this->boundsMax;
+	return true;
+}
 
-	this->shaderProgram.setUniform("MVP", MVP);
-	this->shaderProgram.setUniform("texture0", 0);
-	this->shaderProgram.setUniform("modelMatrix", model);
-	this->shaderProgram.setUniform("lightPosition", ctx.lightSource->getPosition());
-	this->shaderProgram.setUniform("lightColor", ctx.lightSource->getColor());
-	this->shaderProgram.setUniform("viewPosition", ctx.camera.getPosition());
-	checkGLError(__FUNCTION__);
+bool ChunkMesh2::isOccluded(const rendering::RenderingContext& ctx) const {
+	if (ctx.caveCuller && !ctx.caveCuller->isReachable(*this))
+		return true;
 
-	this->vao.draw();
+	return ctx.occlusionCuller && ctx.occlusionCuller->isOccluded(this->boundsMin, this->boundsMax);
 }
 
-bool ChunkMesh2::inFrustum(const rendering::RenderingContext& ctx) {
-	auto& pos = this->startPosition;
-
-	// calculate all 8 vertices of the chunk
-
-	auto scale = (float)CHUNKSIZE;
-
-	std::array<glm::vec3, 8> vertices = {
-		pos * scale, // (pos + glm::vec3(0.0f, 0.0f, 0.0f)
-		(pos + glm::vec3(1.0f, 0.0f, 0.0f)) * scale,
-		(pos + glm::vec3(0.0f, 1.0f, 0.0f)) * scale,
-		(pos + glm::vec3(0.0f, 0.0f, 1.0f)) * scale,
-		(pos + glm::vec3(1.0f, 1.0f, 0.0f)) * scale,
-		(pos + glm::vec3(1.0f, 0.0f, 1.0f)) * scale,
-		(pos + glm::vec3(0.0f, 1.0f, 1.0f)) * scale,
-		(pos + glm::vec3(1.0f, 1.0f, 1.0f)) * scale,
-	};
-	
-	return ctx.frustum->boxIn(vertices);
+bool ChunkMesh2::inFrustum(const rendering::RenderingContext& ctx, const meshing::MeshBuffers& mesh) const {
+	if (mesh.empty())
+		return false;
+
+	const auto origin = this->startPosition * (float)CHUNKSIZE;
+	return ctx.frustum->aabbIn(origin + glm::vec3(mesh.boundsMin), origin + glm::vec3(mesh.boundsMax));
 }
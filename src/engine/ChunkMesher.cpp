@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <memory>
+
+#include <glm/common.hpp>
+
+#include "ChunkMesher.hpp"
+#include "Bits.hpp"
+
+using namespace meshing;
+
+static glm::ivec3 columnVoxel(int axis, int i, int u, int v) {
+	glm::ivec3 pos{};
+	pos[axis] = i;
+	pos[(axis + 1) % 3] = u;
+	pos[(axis + 2) % 3] = v;
+	return pos;
+}
+
+// @brief Pushes the four corners of a quad lying on a face of the voxel grid. The
+//		triangles (0, 1, 2) and (0, 2, 3) are drawn through the shared quad index buffer.
+// @param slice coordinate of the voxel layer along the face axis.
+// @param u, v coordinates of the first voxel of the quad along the other two axes.
+// @param w, h size of the quad (in voxels) along the u and v axes.
+static void emitQuad(MeshBuffers& mesh, int face, int slice, int u, int v, int w, int h, int voxel) {
+	const int axis = face / 2;
+	const int uAxis = (axis + 1) % 3;
+	const int vAxis = (axis + 2) % 3;
+	const bool positive = face % 2;
+
+	glm::ivec3 corner{};
+	corner[axis] = slice + positive;
+	corner[uAxis] = u;
+	corner[vAxis] = v;
+
+	glm::ivec3 du{ 0 };
+	glm::ivec3 dv{ 0 };
+	du[uAxis] = w;
+	dv[vAxis] = h;
+
+	const glm::ivec3 corners[] = { corner, corner + du, corner + du + dv, corner + dv };
+
+	for (const auto& c : corners)
+		mesh.vertices.push_back(packVertex(c.x, c.y, c.z, face, voxel));
+
+	// corners[0] and corners[2] are the opposite ends of the quad.
+	mesh.boundsMin = glm::min(mesh.boundsMin, corners[0]);
+	mesh.boundsMax = glm::max(mesh.boundsMax, corners[2]);
+}
+
+void meshing::beginSnapshot(const VoxelStorage& voxels, ChunkSnapshot& out) {
+	out.voxels.fill(0);
+
+	for (int x = 0; x < CHUNKSIZE; x++)
+		for (int y = 0; y < CHUNKSIZE; y++)
+			voxels.getRow(x, y, &out.at(x, y, 0));
+}
+
+void meshing::copyBorder(const glm::ivec3& offset, const VoxelStorage& neighbour, ChunkSnapshot& out) {
+	// range of the snapshot covered by the neighbour along each axis, in chunk
+	// relative coordinates: -1 for the layer below, CHUNKSIZE for the layer above.
+	glm::ivec3 first{}, last{};
+	for (int axis = 0; axis < 3; axis++) {
+		first[axis] = offset[axis] < 0 ? -1 : (offset[axis] > 0 ? CHUNKSIZE : 0);
+		last[axis] = offset[axis] == 0 ? CHUNKSIZE - 1 : first[axis];
+	}
+
+	const glm::ivec3 shift = offset * CHUNKSIZE;
+
+	for (int x = first.x; x <= last.x; x++)
+		for (int y = first.y; y <= last.y; y++)
+			for (int z = first.z; z <= last.z; z++)
+				out.at(x, y, z) = neighbour.get(x - shift.x, y - shift.y, z - shift.z);
+}
+
+void meshing::buildOccupancy(const ChunkSnapshot& snapshot, OccupancyColumns& out) {
+	for (auto& columns : out.axis)
+		columns.fill(0);
+
+	// every solid voxel sets its bit in the columns of the axes along which it is
+	// inside a column of the chunk, so borders only land at the ends of columns.
+	for (int x = -1; x <= CHUNKSIZE; x++) {
+		const bool xIn = x >= 0 && x < CHUNKSIZE;
+
+		for (int y = -1; y <= CHUNKSIZE; y++) {
+			const bool yIn = y >= 0 && y < CHUNKSIZE;
+
+			for (int z = -1; z <= CHUNKSIZE; z++) {
+				const bool zIn = z >= 0 && z < CHUNKSIZE;
+
+				if (!snapshot.at(x, y, z))
+					continue;
+
+				if (yIn && zIn)
+					out.axis[0][z * CHUNKSIZE + y] |= ColumnMask(1) << (x + 1);
+				if (zIn && xIn)
+					out.axis[1][x * CHUNKSIZE + z] |= ColumnMask(1) << (y + 1);
+				if (xIn && yIn)
+					out.axis[2][y * CHUNKSIZE + x] |= ColumnMask(1) << (z + 1);
+			}
+		}
+	}
+}
+
+void meshing::cullFaces(const OccupancyColumns& occupancy, FaceMasks& out) {
+	constexpr ColumnMask interior = ((ColumnMask(1) << CHUNKSIZE) - 1) << 1;
+
+	for (int axis = 0; axis < 3; axis++) {
+		auto& negative = out.faces[axis * 2];
+		auto& positive = out.faces[axis * 2 + 1];
+
+		for (int i = 0; i < COLUMNS; i++) {
+			const auto solid = occupancy.axis[axis][i];
+
+			// a voxel has a visible face towards a direction when it is solid and
+			// the next voxel in that direction is not.
+			negative[i] = ((solid & ~(solid << 1)) & interior) >> 1;
+			positive[i] = ((solid & ~(solid >> 1)) & interior) >> 1;
+		}
+	}
+}
+
+void meshing::emitNaive(const ChunkSnapshot& snapshot, const FaceMasks& masks, MeshBuffers& out) {
+	for (int face = 0; face < FaceCount; face++) {
+		const int axis = face / 2;
+
+		for (int v = 0; v < CHUNKSIZE; v++) {
+			for (int u = 0; u < CHUNKSIZE; u++) {
+				for (auto bits = masks.faces[face][v * CHUNKSIZE + u]; bits; bits &= bits - 1) {
+					const int slice = lowestBit(bits);
+					const auto pos = columnVoxel(axis, slice, u, v);
+
+					emitQuad(out, face, slice, u, v, 1, 1, snapshot.at(pos.x, pos.y, pos.z));
+				}
+			}
+		}
+	}
+}
+
+void meshing::emitGreedy(const ChunkSnapshot& snapshot, const FaceMasks& masks, MeshBuffers& out) {
+	// visible faces of every slice, indexed as [slice][v * CHUNKSIZE + u]. Holds the
+	// voxel id of the face or 0 if there is no visible face.
+	std::array<std::array<VoxelId, COLUMNS>, CHUNKSIZE> slices;
+
+	for (int face = 0; face < FaceCount; face++) {
+		const int axis = face / 2;
+
+		for (auto& slice : slices)
+			slice.fill(0);
+
+		ColumnMask usedSlices = 0;
+
+		for (int v = 0; v < CHUNKSIZE; v++) {
+			for (int u = 0; u < CHUNKSIZE; u++) {
+				const auto bits = masks.faces[face][v * CHUNKSIZE + u];
+				usedSlices |= bits;
+
+				for (auto b = bits; b; b &= b - 1) {
+					const int slice = lowestBit(b);
+					const auto pos = columnVoxel(axis, slice, u, v);
+
+					slices[slice][v * CHUNKSIZE + u] = snapshot.at(pos.x, pos.y, pos.z);
+				}
+			}
+		}
+
+		for (; usedSlices; usedSlices &= usedSlices - 1) {
+			const int slice = lowestBit(usedSlices);
+			auto& mask = slices[slice];
+
+			// merge the faces of the slice into maximal rectangles. Grow the rectangle
+			// along u first and then along v while the whole row matches.
+			for (int v = 0; v < CHUNKSIZE; v++) {
+				for (int u = 0; u < CHUNKSIZE;) {
+					const auto voxel = mask[v * CHUNKSIZE + u];
+
+					if (!voxel) {
+						u++;
+						continue;
+					}
+
+					int w = 1;
+					while (u + w < CHUNKSIZE && mask[v * CHUNKSIZE + u + w] == voxel)
+						w++;
+
+					int h = 1;
+					for (; v + h < CHUNKSIZE; h++) {
+						const auto row = mask.begin() + (v + h) * CHUNKSIZE + u;
+						if (!std::all_of(row, row + w, [voxel](VoxelId id) { return id == voxel; }))
+							break;
+					}
+
+					emitQuad(out, face, slice, u, v, w, h, voxel);
+
+					for (int j = 0; j < h; j++)
+						std::fill_n(mask.begin() + (v + j) * CHUNKSIZE + u, w, 0);
+
+					u += w;
+				}
+			}
+		}
+	}
+}
+
+FaceConnectivity meshing::computeConnectivity(const ChunkSnapshot& snapshot) {
+	constexpr int VOLUME = CHUNKSIZE * CHUNKSIZE * CHUNKSIZE;
+
+	// voxels are indexed as [(x * CHUNKSIZE + y) * CHUNKSIZE + z] and pushed on
+	// the stack when marked, so every voxel is pushed at most once.
+	std::vector<uint8_t> visited(VOLUME, 0);
+	std::vector<int> stack;
+	stack.reserve(VOLUME);
+
+	const auto strides = glm::ivec3{ CHUNKSIZE * CHUNKSIZE, CHUNKSIZE, 1 };
+
+	FaceConnectivity connectivity = 0;
+
+	for (int seed = 0; seed < VOLUME; seed++) {
+		const glm::ivec3 seedPos{ seed / (CHUNKSIZE * CHUNKSIZE), (seed / CHUNKSIZE) % CHUNKSIZE, seed % CHUNKSIZE };
+
+		if (visited[seed] || snapshot.at(seedPos.x, seedPos.y, seedPos.z))
+			continue;
+
+		// faces of the chunk touched by this air region, one bit per Face.
+		unsigned touched = 0;
+
+		visited[seed] = 1;
+		stack.push_back(seed);
+
+		while (!stack.empty()) {
+			const int index = stack.back();
+			stack.pop_back();
+
+			const glm::ivec3 pos{ index / (CHUNKSIZE * CHUNKSIZE), (index / CHUNKSIZE) % CHUNKSIZE, index % CHUNKSIZE };
+
+			for (int face = 0; face < FaceCount; face++) {
+				const int axis = face / 2;
+				const int step = face % 2 ? 1 : -1;
+				const int next = pos[axis] + step;
+
+				if (next < 0 || next >= CHUNKSIZE) {
+					touched |= 1u << face;
+					continue;
+				}
+
+				auto neighbour = pos;
+				neighbour[axis] = next;
+				const int neighbourIndex = index + step * strides[axis];
+
+				if (visited[neighbourIndex] || snapshot.at(neighbour.x, neighbour.y, neighbour.z))
+					continue;
+
+				visited[neighbourIndex] = 1;
+				stack.push_back(neighbourIndex);
+			}
+		}
+
+		for (int a = 0; a < FaceCount; a++)
+			for (int b = a + 1; b < FaceCount; b++)
+				if ((touched >> a & 1) && (touched >> b & 1))
+					connectivity |= FaceConnectivity(1) << facePairBit(a, b);
+
+		if (connectivity == ALLFACESCONNECTED)
+			break;
+	}
+
+	return connectivity;
+}
+
+MeshBuffers meshing::generateMesh(MeshingMode mode, const ChunkSnapshot& snapshot) {
+
+	// both are a few KiB, keep them off the stack.
+	auto occupancy = std::make_unique<OccupancyColumns>();
+	auto masks = std::make_unique<FaceMasks>();
+
+	buildOccupancy(snapshot, *occupancy);
+	cullFaces(*occupancy, *masks);
+
+	MeshBuffers mesh;
+
+	if (mode == MeshingMode::Naive)
+		emitNaive(snapshot, *masks, mesh);
+	else
+		emitGreedy(snapshot, *masks, mesh);
+
+	mesh.connectivity = computeConnectivity(snapshot);
+
+	return mesh;
+}
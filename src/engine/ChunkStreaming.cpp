@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <memory>
+
+#include <glm/common.hpp>
+
+#include "ChunkStreaming.hpp"
+#include "ChunkMesh2.hpp"
+
+ChunkStreamer::ChunkStreamer(ChunkMap<ChunkMesh2*>& world, rendering::Renderer& renderer, MeshingPipeline& meshingPipeline,
+	unsigned int threadCount)
+	:world{ world },
+	renderer{ renderer },
+	meshingPipeline{ meshingPipeline },
+	horizontalRadius{ VIEWRADIUS },
+	verticalRadius{ VERTICALVIEWRADIUS },
+	hysteresis{ STREAMINGHYSTERESIS },
+	maxGenerating{ 0 },
+	cameraChunk{ 0 },
+	dirty{ true },
+	loadQueue{},
+	generating{ 0 },
+	generated{},
+	pool{ threadCount } {
+
+	// enough jobs to keep every worker busy, few enough that the queue follows the camera.
+	this->maxGenerating = static_cast<int>(this->pool.size()) * GENERATIONJOBSPERWORKER;
+}
+
+ChunkStreamer::~ChunkStreamer() {
+	this->unloadAll();
+}
+
+void ChunkStreamer::update(const glm::vec3& cameraPosition) {
+	const auto chunk = glm::ivec3(glm::floor(cameraPosition / (float)CHUNKSIZE));
+
+	if (chunk != this->cameraChunk) {
+		this->cameraChunk = chunk;
+		this->dirty = true;
+	}
+
+	this->collectGenerated();
+
+	if (this->dirty)
+		this->refresh();
+
+	while (this->generating < this->maxGenerating && !this->loadQueue.empty()) {
+		const auto coord = this->loadQueue.back();
+		this->loadQueue.pop_back();
+
+		if (!this->world.contains(coord))
+			this->load(coord);
+	}
+}
+
+void ChunkStreamer::unloadAll() {
+	// the workers may still be writing into chunks that are about to be deleted.
+	this->pool.cancelPending();
+	this->pool.waitIdle();
+
+	{
+		std::lock_guard<std::mutex> lock(this->generatedMutex);
+		this->generated.clear();
+	}
+	this->generating = 0;
+
+	std::vector<std::pair<glm::ivec3, ChunkMesh2*>> chunks;
+	this->world.forEach([&](const glm::ivec3& coord, ChunkMesh2* chunk) {
+		chunks.emplace_back(coord, chunk);
+	});
+
+	for (const auto& [coord, chunk] : chunks)
+		this->unload(coord, chunk);
+
+	this->loadQueue.clear();
+	this->dirty = true;
+}
+
+bool ChunkStreamer::inRadius(const glm::ivec3& coord, int horizontal, int vertical) const {
+	const auto d = coord - this->cameraChunk;
+	return d.x * d.x + d.z * d.z <= horizontal * horizontal && std::abs(d.y) <= vertical;
+}
+
+void ChunkStreamer::refresh() {
+	this->dirty = false;
+
+	// unload what left the radius plus the hysteresis margin.
+	std::vector<std::pair<glm::ivec3, ChunkMesh2*>> outOfRange;
+	this->world.forEach([&](const glm::ivec3& coord, ChunkMesh2* chunk) {
+		// chunks with a stage running are checked again once it is collected.
+		if (!chunk->isStageRunning() && !this->inRadius(coord, this->horizontalRadius + this->hysteresis, this->verticalRadius + this->hysteresis))
+			outOfRange.emplace_back(coord, chunk);
+	});
+
+	for (const auto& [coord, chunk] : outOfRange)
+		this->unload(coord, chunk);
+
+	this->loadQueue.clear();
+
+	for (int dx = -this->horizontalRadius; dx <= this->horizontalRadius; dx++) {
+		for (int dz = -this->horizontalRadius; dz <= this->horizontalRadius; dz++) {
+			for (int dy = -this->verticalRadius; dy <= this->verticalRadius; dy++) {
+				const auto coord = this->cameraChunk + glm::ivec3(dx, dy, dz);
+
+				if (this->inRadius(coord, this->horizontalRadius, this->verticalRadius) && !this->world.contains(coord))
+					this->loadQueue.push_back(coord);
+			}
+		}
+	}
+
+	// furthest first, so the nearest chunk is popped from the back.
+	auto distance = [this](const glm::ivec3& coord) {
+		const auto d = coord - this->cameraChunk;
+		return d.x * d.x + d.y * d.y + d.z * d.z;
+	};
+
+	std::sort(this->loadQueue.begin(), this->loadQueue.end(), [&](const glm::ivec3& a, const glm::ivec3& b) {
+		return distance(a) > distance(b);
+	});
+}
+
+void ChunkStreamer::load(const glm::ivec3& coord) {
+	// GL objects are created here, only the voxels are filled by the workers.
+	auto chunk = new ChunkMesh2(glm::vec3(coord));
+
+	// attached to the renderer once generated.
+	this->world.insert(coord, chunk);
+	this->advance(chunk);
+}
+
+void ChunkStreamer::advance(ChunkMesh2* chunk) {
+	if (chunk->isStageRunning() || chunk->isGenerated())
+		return;
+
+	const auto stage = terrain::nextStage(chunk->getStage());
+	const auto coord = chunk->getChunkCoord();
+
+	// copied here, the neighbours may be unloaded while the job runs.
+	std::shared_ptr<terrain::HeightmapNeighbourhood> heightmaps;
+
+	if (terrain::needsNeighbours(stage)) {
+		heightmaps = std::make_shared<terrain::HeightmapNeighbourhood>();
+
+		for (int dx = -1; dx <= 1; dx++) {
+			for (int dz = -1; dz <= 1; dz++) {
+				auto neighbour = this->world.neighbour(coord, glm::ivec3(dx, 0, dz));
+
+				// retried when the neighbour completes a stage.
+				if (!neighbour || (*neighbour)->getStage() < chunk->getStage())
+					return;
+
+				heightmaps->maps[(dx + 1) * 3 + (dz + 1)] = (*neighbour)->getHeightmap();
+			}
+		}
+	}
+
+	chunk->beginStage();
+	this->generating++;
+
+	this->pool.submit([this, chunk, stage, heightmaps]() {
+		chunk->generateStage(stage, heightmaps.get());
+
+		std::lock_guard<std::mutex> lock(this->generatedMutex);
+		this->generated.push_back({ chunk, stage });
+	});
+}
+
+void ChunkStreamer::collectGenerated() {
+	std::vector<FinishedStage> finished;
+	{
+		std::lock_guard<std::mutex> lock(this->generatedMutex);
+		finished.swap(this->generated);
+	}
+
+	for (const auto& [chunk, stage] : finished) {
+		this->generating--;
+		chunk->finishStage(stage);
+
+		const auto coord = chunk->getChunkCoord();
+
+		// the camera moved away while the stage was running.
+		if (!this->inRadius(coord, this->horizontalRadius + this->hysteresis, this->verticalRadius + this->hysteresis)) {
+			this->unload(coord, chunk);
+			continue;
+		}
+
+		if (chunk->isGenerated()) {
+			chunk->classify();
+
+			// empty chunks are never meshed nor drawn.
+			if (!chunk->isEmpty())
+				this->renderer.attatchObject(chunk);
+
+			this->meshingPipeline.enqueue(chunk);
+
+			// the faces the neighbours share with the new chunk may have changed.
+			for (int face = 0; face < meshing::FaceCount; face++) {
+				glm::ivec3 offset{ 0 };
+				offset[face / 2] = (face % 2) ? 1 : -1;
+
+				auto neighbour = this->world.neighbour(coord, offset);
+				if (neighbour && (*neighbour)->isGenerated())
+					this->meshingPipeline.enqueue(*neighbour);
+			}
+		}
+
+		this->advance(chunk);
+
+		// neighbours may have been waiting for this chunk to reach this stage.
+		for (int dx = -1; dx <= 1; dx++) {
+			for (int dz = -1; dz <= 1; dz++) {
+				auto neighbour = this->world.neighbour(coord, glm::ivec3(dx, 0, dz));
+				if (neighbour && (dx != 0 || dz != 0))
+					this->advance(*neighbour);
+			}
+		}
+	}
+}
+
+void ChunkStreamer::unload(const glm::ivec3& coord, ChunkMesh2* chunk) {
+	this->world.erase(coord);
+	this->renderer.detachObject(chunk);
+	this->meshingPipeline.cancel(chunk);
+	delete chunk;
+}
@@ -0,0 +1,431 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <glm/common.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CULLING_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULLING_SSE2 1
+#endif
+
+#include "Culling.hpp"
+#include "Bits.hpp"
+
+using namespace culling;
+
+uint32_t BoxArray::add(const glm::vec3& min, const glm::vec3& max) {
+	const auto index = static_cast<uint32_t>(this->size());
+
+	for (auto array : { &this->centerX, &this->centerY, &this->centerZ, &this->extentX, &this->extentY, &this->extentZ })
+		array->push_back(0.0f);
+
+	this->set(index, min, max);
+	return index;
+}
+
+uint32_t BoxArray::addUnbounded() {
+	const auto index = this->add(glm::vec3(0.0f), glm::vec3(0.0f));
+	this->setUnbounded(index);
+	return index;
+}
+
+void BoxArray::set(uint32_t index, const glm::vec3& min, const glm::vec3& max) {
+	const auto center = (min + max) * 0.5f;
+	const auto extent = (max - min) * 0.5f;
+
+	this->centerX[index] = center.x;
+	this->centerY[index] = center.y;
+	this->centerZ[index] = center.z;
+	this->extentX[index] = extent.x;
+	this->extentY[index] = extent.y;
+	this->extentZ[index] = extent.z;
+}
+
+void BoxArray::setUnbounded(uint32_t index) {
+	this->set(index, glm::vec3(0.0f), glm::vec3(0.0f));
+	this->extentX[index] = this->extentY[index] = this->extentZ[index] = UNBOUNDEDEXTENT;
+}
+
+void BoxArray::setEmpty(uint32_t index) {
+	this->set(index, glm::vec3(0.0f), glm::vec3(0.0f));
+	this->extentX[index] = this->extentY[index] = this->extentZ[index] = EMPTYEXTENT;
+}
+
+void BoxArray::removeSwap(uint32_t index) {
+	for (auto array : { &this->centerX, &this->centerY, &this->centerZ, &this->extentX, &this->extentY, &this->extentZ }) {
+		(*array)[index] = array->back();
+		array->pop_back();
+	}
+}
+
+void BoxArray::clear() {
+	for (auto array : { &this->centerX, &this->centerY, &this->centerZ, &this->extentX, &this->extentY, &this->extentZ })
+		array->clear();
+}
+
+// A box is outside of a plane when even its corner furthest along the plane
+// normal is behind it, and fully in front of it when its nearest corner is:
+//		dot(n, center) + w + dot(abs(n), extent) < 0	outside
+//		dot(n, center) + w - dot(abs(n), extent) >= 0	inside
+// A box outside of any of the 6 planes is culled, a box inside all of them is
+// fully inside the frustum.
+
+static Containment classifyOne(const Frustum& frustum, const BoxArray& boxes, size_t i) {
+	bool inside = true;
+
+	for (const auto& p : frustum.getPlanes()) {
+		const auto& n = p.plane;
+
+		// same order of operations as the SIMD paths.
+		float d = n.x * boxes.centerX[i] + n.w;
+		d += n.y * boxes.centerY[i];
+		d += n.z * boxes.centerZ[i];
+
+		float r = std::abs(n.x) * boxes.extentX[i];
+		r += std::abs(n.y) * boxes.extentY[i];
+		r += std::abs(n.z) * boxes.extentZ[i];
+
+		if (d + r < 0)
+			return Containment::Outside;
+
+		inside = inside && d - r >= 0;
+	}
+
+	return inside ? Containment::Inside : Containment::Intersect;
+}
+
+// @brief Calls @emit(index, fullyInside) for every box of @boxes in [begin, end)
+//		that isn't outside of @frustum, in increasing order.
+template<typename Emit>
+static void classifyRange(const Frustum& frustum, const BoxArray& boxes, size_t begin, size_t end, Emit&& emit) {
+	const auto& planes = frustum.getPlanes();
+	size_t i = begin;
+
+#ifdef CULLING_AVX2
+	for (; i + 8 <= end; i += 8) {
+		const __m256 cx = _mm256_loadu_ps(&boxes.centerX[i]);
+		const __m256 cy = _mm256_loadu_ps(&boxes.centerY[i]);
+		const __m256 cz = _mm256_loadu_ps(&boxes.centerZ[i]);
+		const __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+		const __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+		const __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+
+		__m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		__m256 inside = visible;
+
+		for (const auto& p : planes) {
+			const auto& n = p.plane;
+
+			__m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(n.x), cx), _mm256_set1_ps(n.w));
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(n.y), cy));
+			d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(n.z), cz));
+
+			__m256 r = _mm256_mul_ps(_mm256_set1_ps(std::abs(n.x)), ex);
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(std::abs(n.y)), ey));
+			r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(std::abs(n.z)), ez));
+
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		const auto insideMask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+
+		for (auto mask = static_cast<uint32_t>(_mm256_movemask_ps(visible)); mask; mask &= mask - 1) {
+			const int bit = lowestBit(mask);
+			emit(static_cast<uint32_t>(i + bit), ((insideMask >> bit) & 1) != 0);
+		}
+	}
+#endif
+
+#ifdef CULLING_SSE2
+	for (; i + 4 <= end; i += 4) {
+		const __m128 cx = _mm_loadu_ps(&boxes.centerX[i]);
+		const __m128 cy = _mm_loadu_ps(&boxes.centerY[i]);
+		const __m128 cz = _mm_loadu_ps(&boxes.centerZ[i]);
+		const __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+		const __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+		const __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 inside = visible;
+
+		for (const auto& p : planes) {
+			const auto& n = p.plane;
+
+			__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.x), cx), _mm_set1_ps(n.w));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(n.y), cy));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(n.z), cz));
+
+			__m128 r = _mm_mul_ps(_mm_set1_ps(std::abs(n.x)), ex);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(std::abs(n.y)), ey));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(std::abs(n.z)), ez));
+
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(d, r), _mm_setzero_ps()));
+		}
+
+		const auto insideMask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+
+		for (auto mask = static_cast<uint32_t>(_mm_movemask_ps(visible)); mask; mask &= mask - 1) {
+			const int bit = lowestBit(mask);
+			emit(static_cast<uint32_t>(i + bit), ((insideMask >> bit) & 1) != 0);
+		}
+	}
+#endif
+
+	for (; i < end; i++) {
+		const auto containment = classifyOne(frustum, boxes, i);
+		if (containment != Containment::Outside)
+			emit(static_cast<uint32_t>(i), containment == Containment::Inside);
+	}
+}
+
+void culling::cullBoxes(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& visible) {
+	visible.clear();
+
+	classifyRange(frustum, boxes, 0, boxes.size(), [&](uint32_t i, bool) {
+		visible.push_back(i);
+	});
+}
+
+void culling::classifyBoxes(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& inside, std::vector<uint32_t>& intersecting) {
+	inside.clear();
+	intersecting.clear();
+
+	classifyRange(frustum, boxes, 0, boxes.size(), [&](uint32_t i, bool fullyInside) {
+		(fullyInside ? inside : intersecting).push_back(i);
+	});
+}
+
+Containment culling::classifyBox(const Frustum& frustum, const BoxArray& boxes, uint32_t index) {
+	return classifyOne(frustum, boxes, index);
+}
+
+// @brief Swaps @value with the last element of @list and drops it.
+static void eraseSwap(std::vector<uint32_t>& list, uint32_t value) {
+	auto it = std::find(list.begin(), list.end(), value);
+	*it = list.back();
+	list.pop_back();
+}
+
+glm::ivec3 BoxHierarchy::regionOf(const glm::ivec3& column) {
+	auto floorDiv = [](int a, int b) { return (a >= 0 ? a : a - b + 1) / b; };
+	return { floorDiv(column.x, REGIONCOLUMNS), 0, floorDiv(column.z, REGIONCOLUMNS) };
+}
+
+void BoxHierarchy::update(uint32_t slot, const BoxArray& boxes) {
+	if (slot >= this->slots.size())
+		this->slots.resize(slot + 1, SlotInfo{ Placement::None, glm::ivec3(0) });
+
+	this->detach(slot);
+
+	auto& info = this->slots[slot];
+
+	if (boxes.extentX[slot] < 0) {
+		info.placement = Placement::None;
+		return;
+	}
+
+	if (boxes.extentX[slot] >= UNBOUNDEDEXTENT) {
+		info.placement = Placement::Loose;
+		this->loose.push_back(slot);
+		return;
+	}
+
+	info.placement = Placement::Grouped;
+	info.column = glm::ivec3(
+		static_cast<int>(std::floor(boxes.centerX[slot] / CHUNKSIZE)),
+		0,
+		static_cast<int>(std::floor(boxes.centerZ[slot] / CHUNKSIZE)));
+
+	const auto regionCoord = regionOf(info.column);
+
+	auto region = this->regions.find(regionCoord);
+	if (!region) {
+		this->regions.insert(regionCoord, Region{ {}, {}, glm::vec3(0.0f), glm::vec3(0.0f), true });
+		region = this->regions.find(regionCoord);
+	}
+
+	auto column = std::find_if(region->columns.begin(), region->columns.end(),
+		[&](const Column& c) { return c.coord == info.column; });
+
+	if (column == region->columns.end()) {
+		region->columns.push_back(Column{ info.column, {} });
+		column = region->columns.end() - 1;
+	}
+
+	column->slots.push_back(slot);
+	region->dirty = true;
+}
+
+void BoxHierarchy::remove(uint32_t slot, uint32_t last) {
+	this->detach(slot);
+
+	if (last != slot) {
+		// box @last now lives in @slot, rename it where it is listed.
+		const auto info = this->slots[last];
+
+		if (info.placement == Placement::Loose) {
+			*std::find(this->loose.begin(), this->loose.end(), last) = slot;
+		}
+		else if (info.placement == Placement::Grouped) {
+			auto region = this->regions.find(regionOf(info.column));
+			auto column = std::find_if(region->columns.begin(), region->columns.end(),
+				[&](const Column& c) { return c.coord == info.column; });
+
+			*std::find(column->slots.begin(), column->slots.end(), last) = slot;
+		}
+
+		this->slots[slot] = info;
+	}
+
+	this->slots.resize(last);
+}
+
+void BoxHierarchy::detach(uint32_t slot) {
+	auto& info = this->slots[slot];
+
+	if (info.placement == Placement::Loose) {
+		eraseSwap(this->loose, slot);
+	}
+	else if (info.placement == Placement::Grouped) {
+		const auto regionCoord = regionOf(info.column);
+		auto region = this->regions.find(regionCoord);
+
+		auto column = std::find_if(region->columns.begin(), region->columns.end(),
+			[&](const Column& c) { return c.coord == info.column; });
+
+		eraseSwap(column->slots, slot);
+
+		if (column->slots.empty()) {
+			*column = std::move(region->columns.back());
+			region->columns.pop_back();
+		}
+
+		region->dirty = true;
+
+		if (region->columns.empty())
+			this->regions.erase(regionCoord);
+	}
+
+	info.placement = Placement::None;
+}
+
+void BoxHierarchy::refresh(Region& region, const BoxArray& boxes) {
+	region.columnBounds.clear();
+	region.min = glm::vec3(UNBOUNDEDEXTENT);
+	region.max = glm::vec3(-UNBOUNDEDEXTENT);
+
+	for (const auto& column : region.columns) {
+		glm::vec3 min{ UNBOUNDEDEXTENT };
+		glm::vec3 max{ -UNBOUNDEDEXTENT };
+
+		for (auto slot : column.slots) {
+			const glm::vec3 center{ boxes.centerX[slot], boxes.centerY[slot], boxes.centerZ[slot] };
+			const glm::vec3 extent{ boxes.extentX[slot], boxes.extentY[slot], boxes.extentZ[slot] };
+
+			min = glm::min(min, center - extent);
+			max = glm::max(max, center + extent);
+		}
+
+		region.columnBounds.add(min, max);
+		region.min = glm::min(region.min, min);
+		region.max = glm::max(region.max, max);
+	}
+
+	region.dirty = false;
+}
+
+void BoxHierarchy::cull(const Frustum& frustum, const BoxArray& boxes, std::vector<uint32_t>& visible) {
+	visible.assign(this->loose.begin(), this->loose.end());
+
+	this->regionList.clear();
+	this->regionBounds.clear();
+
+	this->regions.forEach([&](const glm::ivec3&, Region& region) {
+		if (region.dirty)
+			this->refresh(region, boxes);
+
+		this->regionList.push_back(&region);
+		this->regionBounds.add(region.min, region.max);
+	});
+
+	classifyBoxes(frustum, this->regionBounds, this->insideRegions, this->intersectingRegions);
+
+	for (auto r : this->insideRegions)
+		for (const auto& column : this->regionList[r]->columns)
+			visible.insert(visible.end(), column.slots.begin(), column.slots.end());
+
+	for (auto r : this->intersectingRegions) {
+		const auto& region = *this->regionList[r];
+
+		classifyBoxes(frustum, region.columnBounds, this->insideColumns, this->intersectingColumns);
+
+		for (auto c : this->insideColumns)
+			visible.insert(visible.end(), region.columns[c].slots.begin(), region.columns[c].slots.end());
+
+		for (auto c : this->intersectingColumns)
+			for (auto slot : region.columns[c].slots)
+				if (classifyOne(frustum, boxes, slot) != Containment::Outside)
+					visible.push_back(slot);
+	}
+}
+
+// @brief Quantized @squaredDistance. The bits of a non negative float grow with
+//		its value, the top 16 keep the exponent and 7 bits of the mantissa.
+static uint16_t distanceKey(float squaredDistance) {
+	uint32_t bits;
+	std::memcpy(&bits, &squaredDistance, sizeof(bits));
+	return static_cast<uint16_t>(bits >> 16);
+}
+
+void DistanceSorter::sort(const BoxArray& boxes, const glm::vec3& eye, std::vector<uint32_t>& indices) {
+	const auto count = indices.size();
+
+	this->keys.resize(count);
+	this->sortedKeys.resize(count);
+	this->sortedIndices.resize(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const auto index = indices[i];
+
+		if (boxes.extentX[index] >= UNBOUNDEDEXTENT) {
+			this->keys[i] = 0;
+			continue;
+		}
+
+		const float dx = boxes.centerX[index] - eye.x;
+		const float dy = boxes.centerY[index] - eye.y;
+		const float dz = boxes.centerZ[index] - eye.z;
+		this->keys[i] = distanceKey(dx * dx + dy * dy + dz * dz);
+	}
+
+	// least significant byte first, each pass is a stable counting sort.
+	for (int shift = 0; shift < 16; shift += 8) {
+		size_t offsets[256] = {};
+		for (size_t i = 0; i < count; i++)
+			offsets[(this->keys[i] >> shift) & 0xFF]++;
+
+		size_t total = 0;
+		for (auto& offset : offsets) {
+			const auto bucket = offset;
+			offset = total;
+			total += bucket;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			const auto destination = offsets[(this->keys[i] >> shift) & 0xFF]++;
+			this->sortedKeys[destination] = this->keys[i];
+			this->sortedIndices[destination] = indices[i];
+		}
+
+		this->keys.swap(this->sortedKeys);
+		indices.swap(this->sortedIndices);
+	}
+}
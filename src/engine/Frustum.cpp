@@ -5,7 +5,7 @@ Frustum::Frustum(const FPSCamera& cam) {
 }
 
 void Frustum::update(const FPSCamera& cam) {
-	auto& matrix = cam.getPVMatrix();
+	const auto matrix = cam.getPVMatrix();
 
 	auto rowX = glm::row(matrix, 0);
 	auto rowY = glm::row(matrix, 1);
@@ -40,10 +40,26 @@ bool Frustum::boxIn(const std::array<glm::vec3, 8>& vertices) {
 				in++;
 		}
 
+		// a box crossing this plane can still be outside of another one.
 		if (!in)
 			return false;
-		else if (out) // maybe return something else for intersection
-			return true;
+	}
+
+	return true;
+}
+
+bool Frustum::aabbIn(const glm::vec3& min, const glm::vec3& max) const {
+	for (const auto& p : this->planes) {
+		// the corner of the box furthest along the plane normal, if it is
+		// behind the plane the whole box is.
+		const glm::vec3 positive{
+			p.plane.x >= 0 ? max.x : min.x,
+			p.plane.y >= 0 ? max.y : min.y,
+			p.plane.z >= 0 ? max.z : min.z,
+		};
+
+		if (p.signDistance(positive) < 0)
+			return false;
 	}
 
 	return true;
@@ -14,6 +14,7 @@ CubeLight::CubeLight(const glm::vec3& pos)
 		.shaderFromFile(SHADERSDIR "/lightCube.vert")
 		.fragmentFromFile(SHADERSDIR "/lightCube.frag")
 		.build());
+	this->shaderProgram.bindUniformBlock(rendering::FRAMEUNIFORMSBLOCK, rendering::FRAMEUNIFORMSBINDING);
 
 	this->textureLoader
 		.loadTexture(TEXTUREDIR "/awesomeface.png");
@@ -111,7 +112,7 @@ void CubeLight::preRender() {
 	this->vao.verticesN = 36;
 }
 
-void CubeLight::render(const rendering::RenderingContext& ctx) {
+void CubeLight::render([[maybe_unused]] const rendering::RenderingContext& ctx) {
 	if (this->doPreRender)
 		this->preRender();
 
@@ -128,18 +129,13 @@ void CubeLight::render(const rendering::RenderingContext& ctx) {
 	this->shaderProgram.use();
 	this->textureLoader.enableTextures();
 	this->shaderProgram.setUniform("texture0", 0);
-
-	auto MVP = ctx.camera.getProjectionMatrix()
-		* ctx.camera.getViewMatrix()
-		* model;
-
-	this->shaderProgram.setUniform("MVP", MVP);
+	this->shaderProgram.setUniform("modelMatrix", model);
 	this->vao.draw();
 
 	//this->setLightingUniforms(ctx);
 }
 
-void CubeLight::setLightingUniforms(const rendering::RenderingContext& ctx) {
+void CubeLight::setLightingUniforms([[maybe_unused]] const rendering::RenderingContext& ctx) {
 	// WARNING: Shader dependent code. This only works for the "chunk.frag" fragment shader.
 	// for any other shader program rewrite this method.
 	for (const auto sp : this->affectedObjectsSP) {
@@ -0,0 +1,149 @@
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include "MeshingPipeline.hpp"
+#include "ChunkMesh2.hpp"
+
+MeshingPipeline::MeshingPipeline(rendering::Renderer& renderer, unsigned int threadCount)
+	:renderer{ renderer },
+	queued{},
+	queuedSet{},
+	latestTicket{},
+	nextTicket{ 0 },
+	finished{},
+	pendingUploads{},
+	uploadBytesBudget{ MESHUPLOADBYTESPERFRAME },
+	uploadTimeBudget{ MESHUPLOADMSPERFRAME },
+	pool{ threadCount } {
+}
+
+void MeshingPipeline::enqueue(ChunkMesh2* chunk) {
+	// air only, there is nothing to mesh whatever the neighbours are.
+	if (chunk->isEmpty())
+		return;
+
+	if (this->queuedSet.insert(chunk).second)
+		this->queued.push_back(chunk);
+}
+
+void MeshingPipeline::cancel(ChunkMesh2* chunk) {
+	if (this->queuedSet.erase(chunk))
+		this->queued.erase(std::find(this->queued.begin(), this->queued.end(), chunk));
+
+	this->latestTicket.erase(chunk);
+}
+
+void MeshingPipeline::update(const rendering::RenderingContext& ctx) {
+	this->uploadFinished(ctx);
+	this->submitQueued(ctx);
+}
+
+bool MeshingPipeline::isObsolete(const MeshResult& result) const {
+	// the chunk was cancelled or queued again after this job started.
+	auto it = this->latestTicket.find(result.chunk);
+	return it == this->latestTicket.end() || it->second != result.ticket;
+}
+
+void MeshingPipeline::uploadFinished(const rendering::RenderingContext& ctx) {
+	{
+		std::lock_guard<std::mutex> lock(this->finishedMutex);
+		std::move(this->finished.begin(), this->finished.end(), std::back_inserter(this->pendingUploads));
+		this->finished.clear();
+	}
+
+	// drop obsolete meshes before touching their chunks, they may not exist anymore.
+	this->pendingUploads.erase(
+		std::remove_if(this->pendingUploads.begin(), this->pendingUploads.end(),
+			[this](const MeshResult& r) { return this->isObsolete(r); }),
+		this->pendingUploads.end());
+
+	if (this->pendingUploads.empty())
+		return;
+
+	// visible chunks first, then the closest ones.
+	struct UploadOrder {
+		bool hidden;
+		float distance;
+		size_t index;
+
+		bool operator<(const UploadOrder& rhs) const {
+			return hidden != rhs.hidden ? rhs.hidden : distance < rhs.distance;
+		}
+	};
+
+	const auto cameraPosition = ctx.camera.getPosition();
+
+	std::vector<UploadOrder> order;
+	order.reserve(this->pendingUploads.size());
+
+	for (size_t i = 0; i < this->pendingUploads.size(); i++) {
+		const auto& result = this->pendingUploads[i];
+		const auto center = (result.chunk->getStartPosition() + glm::vec3(0.5f)) * (float)CHUNKSIZE;
+
+		order.push_back({ !result.chunk->inFrustum(ctx, result.mesh), glm::distance(center, cameraPosition), i });
+	}
+
+	std::sort(order.begin(), order.end());
+
+	const auto start = std::chrono::steady_clock::now();
+	size_t uploadedBytes = 0;
+	size_t uploaded = 0;
+
+	for (; uploaded < order.size(); uploaded++) {
+		auto& result = this->pendingUploads[order[uploaded].index];
+		const auto bytes = result.mesh.vertices.size() * sizeof(meshing::PackedVertex);
+
+		const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (uploaded > 0 && (uploadedBytes + bytes > this->uploadBytesBudget || elapsed.count() >= this->uploadTimeBudget))
+			break;
+
+		this->latestTicket.erase(result.chunk);
+		result.chunk->uploadMesh(result.mesh);
+		this->renderer.updateBounds(result.chunk);
+		uploadedBytes += bytes;
+	}
+
+	// keep the meshes that didn't fit in this frame.
+	std::vector<MeshResult> remaining;
+	remaining.reserve(order.size() - uploaded);
+
+	for (size_t i = uploaded; i < order.size(); i++)
+		remaining.push_back(std::move(this->pendingUploads[order[i].index]));
+
+	this->pendingUploads.swap(remaining);
+}
+
+void MeshingPipeline::submitQueued(const rendering::RenderingContext& ctx) {
+	const auto mode = ChunkMesh2::getMeshingMode();
+
+	for (auto chunk : this->queued) {
+		// a solid chunk surrounded by solid chunks has no visible face, clear its
+		// mesh right away and drop the jobs in flight.
+		if (chunk->isBuried(ctx)) {
+			this->latestTicket.erase(chunk);
+			chunk->uploadMesh(meshing::MeshBuffers{});
+			this->renderer.updateBounds(chunk);
+			continue;
+		}
+
+		// the snapshot is taken here so the workers never touch the live world.
+		auto snapshot = std::make_shared<meshing::ChunkSnapshot>();
+		chunk->captureSnapshot(ctx, *snapshot);
+
+		const auto ticket = ++this->nextTicket;
+		this->latestTicket[chunk] = ticket;
+
+		this->pool.submit([this, chunk, ticket, mode, snapshot]() {
+			MeshResult result{ chunk, ticket, meshing::generateMesh(mode, *snapshot) };
+
+			std::lock_guard<std::mutex> lock(this->finishedMutex);
+			this->finished.push_back(std::move(result));
+		});
+	}
+
+	this->queued.clear();
+	this->queuedSet.clear();
+}
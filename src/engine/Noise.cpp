@@ -0,0 +1,316 @@
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NOISE_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NOISE_SSE2 1
+#endif
+
+#include "Noise.hpp"
+
+// The noise is written once as a template over a "lane" type: a float for the
+// scalar path or a SIMD register. Every lane type provides the same operations,
+// so all paths perform the same IEEE operations in the same order.
+// Keep the operations in the order glm/gtc/noise.inl uses them.
+
+namespace {
+	// scalar lane
+
+	inline float load(const float* p, float) { return *p; }
+	inline void store(float* p, float v) { *p = v; }
+
+	inline float splat(float v, float) { return v; }
+	inline float floorLane(float v) { return std::floor(v); }
+	inline float absLane(float v) { return std::fabs(v); }
+
+	// glm::step(edge, x): 0 if x < edge, 1 otherwise.
+	inline float stepLane(float edge, float x) { return x < edge ? 0.0f : 1.0f; }
+
+#ifdef NOISE_SSE2
+	struct Lane4 {
+		__m128 v;
+	};
+
+	inline Lane4 operator+(Lane4 a, Lane4 b) { return { _mm_add_ps(a.v, b.v) }; }
+	inline Lane4 operator-(Lane4 a, Lane4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+	inline Lane4 operator*(Lane4 a, Lane4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+	inline Lane4 operator+(Lane4 a, float b) { return { _mm_add_ps(a.v, _mm_set1_ps(b)) }; }
+	inline Lane4 operator-(Lane4 a, float b) { return { _mm_sub_ps(a.v, _mm_set1_ps(b)) }; }
+	inline Lane4 operator*(Lane4 a, float b) { return { _mm_mul_ps(a.v, _mm_set1_ps(b)) }; }
+	inline Lane4 operator/(Lane4 a, float b) { return { _mm_div_ps(a.v, _mm_set1_ps(b)) }; }
+	inline Lane4 operator-(float a, Lane4 b) { return { _mm_sub_ps(_mm_set1_ps(a), b.v) }; }
+	inline Lane4 operator*(float a, Lane4 b) { return { _mm_mul_ps(_mm_set1_ps(a), b.v) }; }
+	inline Lane4& operator-=(Lane4& a, Lane4 b) { return a = a - b; }
+
+	inline Lane4 load(const float* p, Lane4) { return { _mm_loadu_ps(p) }; }
+	inline void store(float* p, Lane4 v) { _mm_storeu_ps(p, v.v); }
+
+	inline Lane4 splat(float v, Lane4) { return { _mm_set1_ps(v) }; }
+
+	// SSE2 has no floor, truncate and step down the negative values that had a
+	// fraction. Exact for |v| < 2^31, far beyond any voxel coordinate.
+	inline Lane4 floorLane(Lane4 a) {
+		const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+		return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f))) };
+	}
+
+	inline Lane4 absLane(Lane4 a) {
+		return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) };
+	}
+
+	inline Lane4 stepLane(Lane4 edge, Lane4 x) {
+		return { _mm_andnot_ps(_mm_cmplt_ps(x.v, edge.v), _mm_set1_ps(1.0f)) };
+	}
+#endif
+
+#ifdef NOISE_AVX2
+	struct Lane8 {
+		__m256 v;
+	};
+
+	inline Lane8 operator+(Lane8 a, Lane8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+	inline Lane8 operator-(Lane8 a, Lane8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline Lane8 operator*(Lane8 a, Lane8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline Lane8 operator+(Lane8 a, float b) { return { _mm256_add_ps(a.v, _mm256_set1_ps(b)) }; }
+	inline Lane8 operator-(Lane8 a, float b) { return { _mm256_sub_ps(a.v, _mm256_set1_ps(b)) }; }
+	inline Lane8 operator*(Lane8 a, float b) { return { _mm256_mul_ps(a.v, _mm256_set1_ps(b)) }; }
+	inline Lane8 operator/(Lane8 a, float b) { return { _mm256_div_ps(a.v, _mm256_set1_ps(b)) }; }
+	inline Lane8 operator-(float a, Lane8 b) { return { _mm256_sub_ps(_mm256_set1_ps(a), b.v) }; }
+	inline Lane8 operator*(float a, Lane8 b) { return { _mm256_mul_ps(_mm256_set1_ps(a), b.v) }; }
+	inline Lane8& operator-=(Lane8& a, Lane8 b) { return a = a - b; }
+
+	inline Lane8 load(const float* p, Lane8) { return { _mm256_loadu_ps(p) }; }
+	inline void store(float* p, Lane8 v) { _mm256_storeu_ps(p, v.v); }
+
+	inline Lane8 splat(float v, Lane8) { return { _mm256_set1_ps(v) }; }
+
+	inline Lane8 floorLane(Lane8 a) {
+		return { _mm256_floor_ps(a.v) };
+	}
+
+	inline Lane8 absLane(Lane8 a) {
+		return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) };
+	}
+
+	inline Lane8 stepLane(Lane8 edge, Lane8 x) {
+		return { _mm256_andnot_ps(_mm256_cmp_ps(x.v, edge.v, _CMP_LT_OQ), _mm256_set1_ps(1.0f)) };
+	}
+#endif
+
+	template<typename V>
+	inline V fract(V x) {
+		return x - floorLane(x);
+	}
+
+	template<typename V>
+	inline V mod289(V x) {
+		return x - floorLane(x * (1.0f / 289.0f)) * 289.0f;
+	}
+
+	template<typename V>
+	inline V permute(V x) {
+		return mod289(((x * 34.0f) + 1.0f) * x);
+	}
+
+	template<typename V>
+	inline V taylorInvSqrt(V r) {
+		return static_cast<float>(1.79284291400159) - static_cast<float>(0.85373472095314) * r;
+	}
+
+	template<typename V>
+	inline V fade(V t) {
+		return (t * t * t) * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	template<typename V>
+	inline V mix(V x, V y, V a) {
+		return x + a * (y - x);
+	}
+
+	template<typename V>
+	inline V dot(V ax, V ay, V bx, V by) {
+		return ax * bx + ay * by;
+	}
+
+	template<typename V>
+	inline V dot(V ax, V ay, V az, V bx, V by, V bz) {
+		return ax * bx + ay * by + az * bz;
+	}
+
+	template<typename V>
+	V perlin2(V x, V y) {
+		const V zero = splat(0.0f, x);
+		const V one = splat(1.0f, x);
+
+		const V fx0 = fract(x);
+		const V fy0 = fract(y);
+		const V fx1 = fx0 - one;
+		const V fy1 = fy0 - one;
+
+		const V ix0 = mod289(floorLane(x) + zero);
+		const V iy0 = mod289(floorLane(y) + zero);
+		const V ix1 = mod289(floorLane(x) + one);
+		const V iy1 = mod289(floorLane(y) + one);
+
+		// corners in the order 00, 10, 01, 11
+		const V i00 = permute(permute(ix0) + iy0);
+		const V i10 = permute(permute(ix1) + iy0);
+		const V i01 = permute(permute(ix0) + iy1);
+		const V i11 = permute(permute(ix1) + iy1);
+
+		auto gradient = [](V i, V& gx, V& gy) {
+			gx = 2.0f * fract(i / 41.0f) - 1.0f;
+			gy = absLane(gx) - 0.5f;
+			const V tx = floorLane(gx + 0.5f);
+			gx = gx - tx;
+
+			const V norm = taylorInvSqrt(dot(gx, gy, gx, gy));
+			gx = gx * norm;
+			gy = gy * norm;
+		};
+
+		V gx00, gy00, gx10, gy10, gx01, gy01, gx11, gy11;
+		gradient(i00, gx00, gy00);
+		gradient(i10, gx10, gy10);
+		gradient(i01, gx01, gy01);
+		gradient(i11, gx11, gy11);
+
+		const V n00 = dot(gx00, gy00, fx0, fy0);
+		const V n10 = dot(gx10, gy10, fx1, fy0);
+		const V n01 = dot(gx01, gy01, fx0, fy1);
+		const V n11 = dot(gx11, gy11, fx1, fy1);
+
+		const V fadeX = fade(fx0);
+		const V fadeY = fade(fy0);
+
+		const V nx0 = mix(n00, n10, fadeX);
+		const V nx1 = mix(n01, n11, fadeX);
+		return static_cast<float>(2.3) * mix(nx0, nx1, fadeY);
+	}
+
+	template<typename V>
+	V perlin3(V x, V y, V z) {
+		const V zero = splat(0.0f, x);
+
+		const V pi0x = mod289(floorLane(x));
+		const V pi0y = mod289(floorLane(y));
+		const V pi0z = mod289(floorLane(z));
+		const V pi1x = mod289(floorLane(x) + 1.0f);
+		const V pi1y = mod289(floorLane(y) + 1.0f);
+		const V pi1z = mod289(floorLane(z) + 1.0f);
+
+		const V pf0x = fract(x);
+		const V pf0y = fract(y);
+		const V pf0z = fract(z);
+		const V pf1x = pf0x - 1.0f;
+		const V pf1y = pf0y - 1.0f;
+		const V pf1z = pf0z - 1.0f;
+
+		// corners in the order 00, 10, 01, 11 on the XY plane
+		const V ixy00 = permute(permute(pi0x) + pi0y);
+		const V ixy10 = permute(permute(pi1x) + pi0y);
+		const V ixy01 = permute(permute(pi0x) + pi1y);
+		const V ixy11 = permute(permute(pi1x) + pi1y);
+
+		auto gradient = [zero](V ixy, V& gx, V& gy, V& gz) {
+			gx = ixy * static_cast<float>(1.0 / 7.0);
+			gy = fract(floorLane(gx) * static_cast<float>(1.0 / 7.0)) - 0.5f;
+			gx = fract(gx);
+			gz = (0.5f - absLane(gx)) - absLane(gy);
+			const V sz = stepLane(gz, zero);
+			gx -= sz * (stepLane(zero, gx) - 0.5f);
+			gy -= sz * (stepLane(zero, gy) - 0.5f);
+
+			const V norm = taylorInvSqrt(dot(gx, gy, gz, gx, gy, gz));
+			gx = gx * norm;
+			gy = gy * norm;
+			gz = gz * norm;
+		};
+
+		V gx[8], gy[8], gz[8];
+		const V corners[8] = {
+			permute(ixy00 + pi0z), permute(ixy10 + pi0z), permute(ixy01 + pi0z), permute(ixy11 + pi0z),
+			permute(ixy00 + pi1z), permute(ixy10 + pi1z), permute(ixy01 + pi1z), permute(ixy11 + pi1z),
+		};
+
+		for (int i = 0; i < 8; i++)
+			gradient(corners[i], gx[i], gy[i], gz[i]);
+
+		const V n000 = dot(gx[0], gy[0], gz[0], pf0x, pf0y, pf0z);
+		const V n100 = dot(gx[1], gy[1], gz[1], pf1x, pf0y, pf0z);
+		const V n010 = dot(gx[2], gy[2], gz[2], pf0x, pf1y, pf0z);
+		const V n110 = dot(gx[3], gy[3], gz[3], pf1x, pf1y, pf0z);
+		const V n001 = dot(gx[4], gy[4], gz[4], pf0x, pf0y, pf1z);
+		const V n101 = dot(gx[5], gy[5], gz[5], pf1x, pf0y, pf1z);
+		const V n011 = dot(gx[6], gy[6], gz[6], pf0x, pf1y, pf1z);
+		const V n111 = dot(gx[7], gy[7], gz[7], pf1x, pf1y, pf1z);
+
+		const V fadeX = fade(pf0x);
+		const V fadeY = fade(pf0y);
+		const V fadeZ = fade(pf0z);
+
+		const V nz00 = mix(n000, n001, fadeZ);
+		const V nz10 = mix(n100, n101, fadeZ);
+		const V nz01 = mix(n010, n011, fadeZ);
+		const V nz11 = mix(n110, n111, fadeZ);
+
+		const V nyz0 = mix(nz00, nz01, fadeY);
+		const V nyz1 = mix(nz10, nz11, fadeY);
+
+		return static_cast<float>(2.2) * mix(nyz0, nyz1, fadeX);
+	}
+
+	// @brief Runs @count points through the widest lane type @V, the rest goes
+	//		to the next narrower path. Returns the amount of points done.
+	template<typename V, int WIDTH>
+	int batch2(const float* xs, const float* ys, int count, float* out) {
+		int i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+			store(out + i, perlin2(load(xs + i, V{}), load(ys + i, V{})));
+		return i;
+	}
+
+	template<typename V, int WIDTH>
+	int batch3(const float* xs, const float* ys, const float* zs, int count, float* out) {
+		int i = 0;
+		for (; i + WIDTH <= count; i += WIDTH)
+			store(out + i, perlin3(load(xs + i, V{}), load(ys + i, V{}), load(zs + i, V{})));
+		return i;
+	}
+}
+
+float noise::perlin(const glm::vec2& p) {
+	return perlin2(p.x, p.y);
+}
+
+float noise::perlin(const glm::vec3& p) {
+	return perlin3(p.x, p.y, p.z);
+}
+
+void noise::perlin(const float* xs, const float* ys, int count, float* out) {
+	int i = 0;
+
+#ifdef NOISE_AVX2
+	i += batch2<Lane8, 8>(xs + i, ys + i, count - i, out + i);
+#endif
+#ifdef NOISE_SSE2
+	i += batch2<Lane4, 4>(xs + i, ys + i, count - i, out + i);
+#endif
+	i += batch2<float, 1>(xs + i, ys + i, count - i, out + i);
+}
+
+void noise::perlin(const float* xs, const float* ys, const float* zs, int count, float* out) {
+	int i = 0;
+
+#ifdef NOISE_AVX2
+	i += batch3<Lane8, 8>(xs + i, ys + i, zs + i, count - i, out + i);
+#endif
+#ifdef NOISE_SSE2
+	i += batch3<Lane4, 4>(xs + i, ys + i, zs + i, count - i, out + i);
+#endif
+	batch3<float, 1>(xs + i, ys + i, zs + i, count - i, out + i);
+}
@@ -0,0 +1,312 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <glm/common.hpp>
+
+// OCCLUSION_NO_SIMD forces the scalar paths, the tests build both.
+#if !defined(OCCLUSION_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OCCLUSION_SSE2 1
+#endif
+
+#include "Occlusion.hpp"
+
+using namespace occlusion;
+
+static constexpr float FARDEPTH = std::numeric_limits<float>::infinity();
+
+// @brief Corner @index of the box, bit 0 picks max.x, bit 1 max.y and bit 2 max.z.
+static glm::vec3 boxCorner(const Box& box, int index) {
+	return {
+		index & 1 ? box.max.x : box.min.x,
+		index & 2 ? box.max.y : box.min.y,
+		index & 4 ? box.max.z : box.min.z,
+	};
+}
+
+// @brief Clamps a pixel coordinate before converting it, projections of points
+//		close to the camera can be far outside the buffer.
+static int clampPixel(float value, int size) {
+	return static_cast<int>(std::floor(glm::clamp(value, -1.0f, (float)size)));
+}
+
+// @brief Rounds @size up to whole tiles.
+static int tileAligned(int size) {
+	return (std::max(size, 1) + DEPTHTILESIZE - 1) / DEPTHTILESIZE * DEPTHTILESIZE;
+}
+
+// @brief true if a pixel in @row[@first..@last] holds @depth or something farther.
+static bool anyAtOrBehind(const float* row, int first, int last, float depth) {
+#ifdef OCCLUSION_SSE2
+	const auto reference = _mm_set1_ps(depth);
+
+	for (int x = first & ~3; x <= last; x += 4) {
+		// lanes of the block that are inside first..last.
+		int lanes = 0xF;
+		if (x < first)
+			lanes &= 0xF << (first - x);
+		if (x + 3 > last)
+			lanes &= 0xF >> (x + 3 - last);
+
+		if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), reference)) & lanes)
+			return true;
+	}
+#else
+	for (int x = first; x <= last; x++)
+		if (row[x] >= depth)
+			return true;
+#endif
+	return false;
+}
+
+DepthBuffer::DepthBuffer(int width, int height)
+	:width{ tileAligned(width) },
+	height{ tileAligned(height) },
+	depths{},
+	tileDepths{},
+	tilesX{ this->width / DEPTHTILESIZE },
+	quads{},
+	pv{ 1.0f } {
+	this->depths.assign(size_t(this->width) * this->height, FARDEPTH);
+	this->tileDepths.assign(size_t(this->tilesX) * (this->height / DEPTHTILESIZE), FARDEPTH);
+}
+
+glm::vec3 DepthBuffer::toScreen(const glm::vec4& clip) const {
+	return {
+		(clip.x / clip.w * 0.5f + 0.5f) * this->width,
+		(clip.y / clip.w * 0.5f + 0.5f) * this->height,
+		clip.w,
+	};
+}
+
+void DepthBuffer::render(const glm::mat4& pv, const glm::vec3& eye, const std::vector<Box>& occluders, ThreadPool* pool) {
+	this->pv = pv;
+	this->setup(occluders, eye);
+
+	// every band owns its rows, so bands never touch the same pixels.
+	const int bands = pool ? int(pool->size()) + 1 : 1;
+	const int tileRows = this->height / DEPTHTILESIZE;
+	const int rowsPerBand = (tileRows + bands - 1) / bands * DEPTHTILESIZE;
+
+	for (int band = 1; band < bands; band++) {
+		const int first = band * rowsPerBand;
+		const int last = std::min(this->height, first + rowsPerBand);
+		if (first < last)
+			pool->submit([this, first, last]() { this->rasterizeRows(first, last); });
+	}
+
+	this->rasterizeRows(0, std::min(this->height, rowsPerBand));
+
+	if (pool)
+		pool->waitIdle();
+}
+
+void DepthBuffer::setup(const std::vector<Box>& occluders, const glm::vec3& eye) {
+	this->quads.clear();
+
+	for (const auto& box : occluders) {
+		glm::vec3 screen[8];
+		bool projectable = true;
+
+		for (int i = 0; i < 8; i++) {
+			const auto clip = this->pv * glm::vec4(boxCorner(box, i), 1.0f);
+			if (clip.w < NEARW) {
+				projectable = false;
+				break;
+			}
+			screen[i] = this->toScreen(clip);
+		}
+
+		// dropping an occluder only makes the buffer more conservative.
+		if (!projectable)
+			continue;
+
+		for (int axis = 0; axis < 3; axis++) {
+			const int uAxis = (axis + 1) % 3;
+			const int vAxis = (axis + 2) % 3;
+
+			for (int side = 0; side < 2; side++) {
+				// only the faces the eye is in front of are seen.
+				if (side ? eye[axis] <= box.max[axis] : eye[axis] >= box.min[axis])
+					continue;
+
+				const int base = side << axis;
+				const int cycle[4] = { base, base | (1 << uAxis), base | (1 << uAxis) | (1 << vAxis), base | (1 << vAxis) };
+
+				ScreenQuad quad;
+				quad.depth = 0.0f;
+
+				glm::vec2 min{ FARDEPTH }, max{ -FARDEPTH };
+				for (int i = 0; i < 4; i++) {
+					const auto& corner = screen[cycle[i]];
+					quad.corners[i] = glm::vec2(corner);
+					quad.depth = std::max(quad.depth, corner.z);
+					min = glm::min(min, glm::vec2(corner));
+					max = glm::max(max, glm::vec2(corner));
+				}
+
+				// pixel centres are at +0.5.
+				quad.minX = std::max(0, clampPixel(min.x - 0.5f, this->width) + 1);
+				quad.minY = std::max(0, clampPixel(min.y - 0.5f, this->height) + 1);
+				quad.maxX = std::min(this->width - 1, clampPixel(max.x - 0.5f, this->width));
+				quad.maxY = std::min(this->height - 1, clampPixel(max.y - 0.5f, this->height));
+
+				if (quad.minX <= quad.maxX && quad.minY <= quad.maxY)
+					this->quads.push_back(quad);
+			}
+		}
+	}
+}
+
+void DepthBuffer::rasterizeRows(int firstRow, int lastRow) {
+	std::fill(this->depths.begin() + size_t(firstRow) * this->width, this->depths.begin() + size_t(lastRow) * this->width, FARDEPTH);
+
+	for (const auto& quad : this->quads)
+		if (quad.maxY >= firstRow && quad.minY < lastRow)
+			this->rasterizeQuad(quad, firstRow, lastRow);
+
+	for (int tileY = firstRow / DEPTHTILESIZE; tileY < lastRow / DEPTHTILESIZE; tileY++) {
+		for (int tileX = 0; tileX < this->tilesX; tileX++) {
+			float farthest = 0.0f;
+
+			for (int y = 0; y < DEPTHTILESIZE; y++) {
+				const float* row = &this->depths[size_t(tileY * DEPTHTILESIZE + y) * this->width + tileX * DEPTHTILESIZE];
+				for (int x = 0; x < DEPTHTILESIZE; x++)
+					farthest = std::max(farthest, row[x]);
+			}
+
+			this->tileDepths[tileY * this->tilesX + tileX] = farthest;
+		}
+	}
+}
+
+void DepthBuffer::rasterizeQuad(const ScreenQuad& quad, int firstRow, int lastRow) {
+	const auto* v = quad.corners;
+
+	float area = 0.0f;
+	for (int i = 0; i < 4; i++)
+		area += v[i].x * v[(i + 1) % 4].y - v[(i + 1) % 4].x * v[i].y;
+
+	// seen edge on.
+	if (std::abs(area) < 1e-6f)
+		return;
+
+	// edge functions a * x + b * y + c, positive on the inner side of every edge
+	// whichever way the projection turned the corners. They are evaluated at pixel
+	// centres and shifted inwards by half a pixel along both axes, so only pixels
+	// the face covers entirely are written: a pixel on a silhouette may still show
+	// what is behind the occluder.
+	const float sign = area > 0.0f ? 1.0f : -1.0f;
+	float a[4], b[4], c[4];
+	for (int i = 0; i < 4; i++) {
+		const auto& v0 = v[i];
+		const auto& v1 = v[(i + 1) % 4];
+		a[i] = (v0.y - v1.y) * sign;
+		b[i] = (v1.x - v0.x) * sign;
+		c[i] = (v0.x * v1.y - v0.y * v1.x) * sign - 0.5f * (std::abs(a[i]) + std::abs(b[i]));
+	}
+
+	const int y0 = std::max(quad.minY, firstRow);
+	const int y1 = std::min(quad.maxY, lastRow - 1);
+
+	for (int y = y0; y <= y1; y++) {
+		const float py = y + 0.5f;
+		float* row = &this->depths[size_t(y) * this->width];
+
+#ifdef OCCLUSION_SSE2
+		const auto depth = _mm_set1_ps(quad.depth);
+		const auto laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+		// blocks start 4 aligned, the width is a multiple of 4 so they stay inside the row.
+		const int x0 = quad.minX & ~3;
+
+		__m128 edgeA[4], rowEdges[4];
+		for (int i = 0; i < 4; i++) {
+			edgeA[i] = _mm_set1_ps(a[i]);
+			rowEdges[i] = _mm_set1_ps(b[i] * py + c[i]);
+		}
+
+		for (int x = x0; x <= quad.maxX; x += 4) {
+			const auto px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+			auto inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], px), rowEdges[0]), _mm_setzero_ps());
+			for (int i = 1; i < 4; i++)
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[i], px), rowEdges[i]), _mm_setzero_ps()));
+
+			if (!_mm_movemask_ps(inside))
+				continue;
+
+			const auto old = _mm_loadu_ps(row + x);
+			const auto nearer = _mm_min_ps(old, depth);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+		}
+#else
+		for (int x = quad.minX; x <= quad.maxX; x++) {
+			const float px = x + 0.5f;
+
+			bool inside = true;
+			for (int i = 0; i < 4; i++)
+				inside &= a[i] * px + b[i] * py + c[i] >= 0.0f;
+
+			if (inside)
+				row[x] = std::min(row[x], quad.depth);
+		}
+#endif
+	}
+}
+
+bool DepthBuffer::isVisible(const glm::vec3& min, const glm::vec3& max) const {
+	const Box box{ min, max };
+
+	glm::vec2 screenMin{ FARDEPTH }, screenMax{ -FARDEPTH };
+	float nearest = FARDEPTH;
+
+	for (int i = 0; i < 8; i++) {
+		const auto clip = this->pv * glm::vec4(boxCorner(box, i), 1.0f);
+
+		// too close to project, can't tell.
+		if (clip.w < NEARW)
+			return true;
+
+		const auto screen = this->toScreen(clip);
+		screenMin = glm::min(screenMin, glm::vec2(screen));
+		screenMax = glm::max(screenMax, glm::vec2(screen));
+		nearest = std::min(nearest, screen.z);
+	}
+
+	// every pixel the box touches, not only the ones whose centre it covers.
+	const int x0 = std::max(0, clampPixel(screenMin.x, this->width));
+	const int y0 = std::max(0, clampPixel(screenMin.y, this->height));
+	const int x1 = std::min(this->width - 1, clampPixel(screenMax.x, this->width));
+	const int y1 = std::min(this->height - 1, clampPixel(screenMax.y, this->height));
+
+	// off screen.
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	for (int tileY = y0 / DEPTHTILESIZE; tileY <= y1 / DEPTHTILESIZE; tileY++) {
+		const int tileY0 = std::max(y0, tileY * DEPTHTILESIZE);
+		const int tileY1 = std::min(y1, tileY * DEPTHTILESIZE + DEPTHTILESIZE - 1);
+
+		for (int tileX = x0 / DEPTHTILESIZE; tileX <= x1 / DEPTHTILESIZE; tileX++) {
+			// every pixel of the tile is nearer than the box.
+			if (this->tileDepths[tileY * this->tilesX + tileX] < nearest)
+				continue;
+
+			const int tileX0 = std::max(x0, tileX * DEPTHTILESIZE);
+			const int tileX1 = std::min(x1, tileX * DEPTHTILESIZE + DEPTHTILESIZE - 1);
+
+			// the box covers the whole tile, so it covers its farthest pixel.
+			if (tileX1 - tileX0 == DEPTHTILESIZE - 1 && tileY1 - tileY0 == DEPTHTILESIZE - 1)
+				return true;
+
+			// a pixel holding the same depth may be the box's own face.
+			for (int y = tileY0; y <= tileY1; y++)
+				if (anyAtOrBehind(&this->depths[size_t(y) * this->width], tileX0, tileX1, nearest))
+					return true;
+		}
+	}
+
+	return false;
+}
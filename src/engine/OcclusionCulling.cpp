@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include "OcclusionCulling.hpp"
+#include "ChunkMesh2.hpp"
+#include "Frustum.hpp"
+
+// @brief Distance from @point to the closest point of @box.
+static float distanceTo(const occlusion::Box& box, const glm::vec3& point) {
+	return glm::distance(point, glm::clamp(point, box.min, box.max));
+}
+
+// @brief true if every voxel of @chunk is solid.
+static bool isFullySolid(const ChunkMesh2* chunk) {
+	return chunk->isGenerated() && chunk->getSolidLayers() == CHUNKSIZE;
+}
+
+OcclusionCuller::OcclusionCuller(unsigned int threadCount)
+	:occluders{},
+	buffer{ OCCLUSIONBUFFERWIDTH, OCCLUSIONBUFFERHEIGHT },
+	maxOccluders{ MAXOCCLUDERS },
+	enabled{ true },
+	active{ false },
+	pool{ threadCount } {
+}
+
+void OcclusionCuller::update(const rendering::RenderingContext& ctx) {
+	this->active = this->enabled;
+	if (!this->active)
+		return;
+
+	this->collectOccluders(ctx);
+	this->buffer.render(ctx.camera.getPVMatrix(), ctx.camera.getPosition(), this->occluders, &this->pool);
+}
+
+void OcclusionCuller::collectOccluders(const rendering::RenderingContext& ctx) {
+	this->occluders.clear();
+
+	auto& world = *ctx.world;
+
+	world.forEach([&](const glm::ivec3& coord, ChunkMesh2* chunk) {
+		if (!chunk->isGenerated() || chunk->getSolidLayers() == 0)
+			return;
+
+		// a run starts at its lowest chunk, the ones above it are merged in.
+		auto below = world.neighbour(coord, glm::ivec3(0, -1, 0));
+		if (below && isFullySolid(*below))
+			return;
+
+		auto top = coord;
+		int topLayers = chunk->getSolidLayers();
+
+		while (topLayers == CHUNKSIZE) {
+			auto above = world.neighbour(top, glm::ivec3(0, 1, 0));
+			if (!above || !(*above)->isGenerated() || (*above)->getSolidLayers() == 0)
+				break;
+
+			top.y++;
+			topLayers = (*above)->getSolidLayers();
+		}
+
+		const occlusion::Box box{
+			glm::vec3(coord * CHUNKSIZE),
+			glm::vec3(top * CHUNKSIZE) + glm::vec3(CHUNKSIZE, topLayers, CHUNKSIZE),
+		};
+
+		if (ctx.frustum->aabbIn(box.min, box.max))
+			this->occluders.push_back(box);
+	});
+
+	if (this->occluders.size() <= this->maxOccluders)
+		return;
+
+	// near occluders cover the most pixels, keep those.
+	const auto eye = ctx.camera.getPosition();
+	const auto byDistance = [&eye](const occlusion::Box& a, const occlusion::Box& b) {
+		return distanceTo(a, eye) < distanceTo(b, eye);
+	};
+
+	std::nth_element(this->occluders.begin(), this->occluders.begin() + this->maxOccluders, this->occluders.end(), byDistance);
+	this->occluders.resize(this->maxOccluders);
+}
+
+bool OcclusionCuller::isOccluded(const glm::vec3& min, const glm::vec3& max) const {
+	return this->active && !this->buffer.isVisible(min, max);
+}
@@ -1,4 +1,8 @@
+#include <algorithm>
+
 #include "Rendering.hpp"
+#include "ChunkMesher.hpp"
+#include "LightSource.hpp"
 
 static void checkGLError(const char* functionName) {
 	GLenum error;
@@ -103,7 +107,6 @@ MultipleBufferVAO& MultipleBufferVAO::addVertexAttribute(
 	return *this;
 }
 
-
 MultipleBufferVAO& MultipleBufferVAO::addVertexAttribute(
 	const float* attribData,
 	size_t attribDataCount,
@@ -135,23 +138,180 @@ MultipleBufferVAO& MultipleBufferVAO::addVertexAttribute(
 	return *this;
 }
 
+InterleavedVAO& InterleavedVAO::setAttribute(GLuint attribId,
+	GLuint attribSize,
+	GLsizei stride,
+	size_t offset,
+	GLboolean normalize) {
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+	glVertexAttribPointer(attribId, attribSize, GL_FLOAT, normalize, stride, (GLvoid*)offset);
+	glEnableVertexAttribArray(attribId);
+
+	return *this;
+}
+
+InterleavedVAO& InterleavedVAO::setIntegerAttribute(GLuint attribId,
+	GLuint attribSize,
+	GLsizei stride,
+	size_t offset) {
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+	glVertexAttribIPointer(attribId, attribSize, GL_UNSIGNED_INT, stride, (GLvoid*)offset);
+	glEnableVertexAttribArray(attribId);
+
+	return *this;
+}
+
+InterleavedVAO& InterleavedVAO::upload(const void* data, GLsizeiptr bytes, GLsizeiptr vertices) {
+	glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+
+	// grow when the data doesn't fit and shrink when most of the buffer is unused,
+	// leaving some room so a slightly bigger mesh still fits next time.
+	if (bytes > this->capacity || bytes < this->capacity / 4)
+		this->capacity = bytes + bytes / 4;
+
+	// orphans the previous storage, so the driver doesn't have to wait for the
+	// draws that still use it before the new data is written.
+	glBufferData(GL_ARRAY_BUFFER, this->capacity, nullptr, GL_DYNAMIC_DRAW);
+
+	if (bytes > 0)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+
+	checkGLError(__FUNCTION__);
+
+	this->verticesN = vertices;
+	if (this->indexed)
+		this->elementsN = static_cast<GLsizei>(vertices / meshing::VERTICESPERQUAD * meshing::INDICESPERQUAD);
+
+	return *this;
+}
+
+FrameUniformBuffer::FrameUniformBuffer()
+	:ubo{} {
+	glGenBuffers(1, &this->ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAMEUNIFORMSBINDING, this->ubo);
+
+	checkGLError(__FUNCTION__);
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+	glDeleteBuffers(1, &this->ubo);
+}
+
+void FrameUniformBuffer::update(FPSCamera& camera, LightSource& light) {
+	FrameUniforms data{
+		camera.getProjectionMatrix() * camera.getViewMatrix(),
+		glm::vec4(light.getPosition(), 1.0f),
+		glm::vec4(light.getColor(), 1.0f),
+		glm::vec4(camera.getPosition(), 1.0f),
+	};
+
+	glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &data);
+}
+
+QuadIndexBuffer::QuadIndexBuffer()
+	:ebo{} {
+
+	std::vector<QuadIndex> indices;
+	indices.reserve(MAXCHUNKQUADS * 6);
+
+	for (int quad = 0; quad < MAXCHUNKQUADS; quad++) {
+		const auto first = static_cast<QuadIndex>(quad * 4);
+		for (int corner : { 0, 1, 2, 0, 2, 3 })
+			indices.push_back(first + static_cast<QuadIndex>(corner));
+	}
+
+	glGenBuffers(1, &this->ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(QuadIndex), indices.data(), GL_STATIC_DRAW);
+
+	checkGLError(__FUNCTION__);
+}
+
+QuadIndexBuffer& QuadIndexBuffer::getInstance() {
+	// never deleted, it lives as long as the GL context.
+	static QuadIndexBuffer* instance = new QuadIndexBuffer{};
+	return *instance;
+}
+
 Renderer& Renderer::attatchObject(RenderObject* obj) {
+	if (this->slots.count(obj))
+		return *this;
+
+	const auto slot = this->bounds.addUnbounded();
 	this->objects.push_back(obj);
+	this->slots.emplace(obj, slot);
+	this->readBounds(slot);
+
 	return *this;
 }
 
+Renderer& Renderer::detachObject(RenderObject* obj) {
+	auto it = this->slots.find(obj);
+	if (it == this->slots.end())
+		return *this;
+
+	// move the last object into the freed slot.
+	const auto slot = it->second;
+	this->slots.erase(it);
+
+	this->hierarchy.remove(slot, static_cast<uint32_t>(this->objects.size() - 1));
+
+	this->objects[slot] = this->objects.back();
+	this->objects.pop_back();
+	this->bounds.removeSwap(slot);
+
+	if (slot < this->objects.size())
+		this->slots[this->objects[slot]] = slot;
+
+	// the draw order of the last frame must not keep a dangling pointer.
+	this->drawOrder.erase(std::remove(this->drawOrder.begin(), this->drawOrder.end(), obj), this->drawOrder.end());
+
+	return *this;
+}
+
+void Renderer::updateBounds(RenderObject* obj) {
+	auto it = this->slots.find(obj);
+	if (it != this->slots.end())
+		this->readBounds(it->second);
+}
+
+void Renderer::readBounds(uint32_t slot) {
+	glm::vec3 min, max;
+
+	if (!this->objects[slot]->getBounds(min, max))
+		this->bounds.setUnbounded(slot);
+	else if (min.x > max.x || min.y > max.y || min.z > max.z)
+		this->bounds.setEmpty(slot);
+	else
+		this->bounds.set(slot, min, max);
+
+	this->hierarchy.update(slot, this->bounds);
+}
+
 void Renderer::render(const RenderingContext& ctx) {
 
 	int totalObjects = this->objects.size();
 
-	int renderedObjects = 0;
+	this->hierarchy.cull(*ctx.frustum, this->bounds, this->visible);
+	this->sorter.sort(this->bounds, ctx.camera.getPosition(), this->visible);
 
-	for (auto& object : this->objects) {
-		if (object->inFrustum(ctx)) {
-			renderedObjects++;
-			object->render(ctx);
-		}
+	this->drawOrder.clear();
+
+	for (auto slot : this->visible) {
+		auto object = this->objects[slot];
+		if (object->isOccluded(ctx))
+			continue;
+
+		object->render(ctx);
+		this->drawOrder.push_back(object);
 	}
 
+	int renderedObjects = this->drawOrder.size();
+
 	std::cout << "Total objects: " << totalObjects << " Only rendered: " << renderedObjects << '\n';
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+
+#include <glm/vector_relational.hpp>
+
+#include "TerrainGenerator.hpp"
+#include "Noise.hpp"
+
+using namespace terrain;
+
+using VoxelBuffer = std::array<VoxelId, CHUNKVOLUME>;
+
+static int voxelIndex(int x, int y, int z) {
+	return (x * CHUNKSIZE + y) * CHUNKSIZE + z;
+}
+
+// @brief Decodes the voxels of @voxels in the storage order, to be edited and
+//		packed back with VoxelStorage::assign.
+static std::unique_ptr<VoxelBuffer> unpack(const VoxelStorage& voxels) {
+	auto buffer = std::make_unique<VoxelBuffer>();
+
+	for (int x = 0; x < CHUNKSIZE; x++)
+		for (int y = 0; y < CHUNKSIZE; y++)
+			voxels.getRow(x, y, &(*buffer)[voxelIndex(x, y, 0)]);
+
+	return buffer;
+}
+
+// @brief Well mixed hash of a world column, decides where trees grow.
+static uint32_t columnHash(int x, int z) {
+	uint32_t h = static_cast<uint32_t>(x) * 0x8da6b343u ^ static_cast<uint32_t>(z) * 0xd8163841u;
+	h ^= h >> 15;
+	h *= 0x2c1b3c6du;
+	h ^= h >> 12;
+	h *= 0x297a2d39u;
+	h ^= h >> 15;
+	return h;
+}
+
+float DensityLattice::interpolate(int x, int y, int z) const {
+	const int lx = x / DENSITYSTEP;
+	const int ly = y / DENSITYSTEP;
+	const int lz = z / DENSITYSTEP;
+
+	const float fx = float(x % DENSITYSTEP) / DENSITYSTEP;
+	const float fy = float(y % DENSITYSTEP) / DENSITYSTEP;
+	const float fz = float(z % DENSITYSTEP) / DENSITYSTEP;
+
+	auto lerp = [](float a, float b, float t) { return a + t * (b - a); };
+
+	const float c00 = lerp(this->at(lx, ly, lz), this->at(lx, ly, lz + 1), fz);
+	const float c01 = lerp(this->at(lx, ly + 1, lz), this->at(lx, ly + 1, lz + 1), fz);
+	const float c10 = lerp(this->at(lx + 1, ly, lz), this->at(lx + 1, ly, lz + 1), fz);
+	const float c11 = lerp(this->at(lx + 1, ly + 1, lz), this->at(lx + 1, ly + 1, lz + 1), fz);
+
+	return lerp(lerp(c00, c01, fy), lerp(c10, c11, fy), fx);
+}
+
+float HeightmapNeighbourhood::at(int x, int z) const {
+	const int dx = x < 0 ? -1 : (x >= CHUNKSIZE ? 1 : 0);
+	const int dz = z < 0 ? -1 : (z >= CHUNKSIZE ? 1 : 0);
+
+	return this->maps[(dx + 1) * 3 + (dz + 1)].at(x - dx * CHUNKSIZE, z - dz * CHUNKSIZE);
+}
+
+void terrain::computeHeightmap(const glm::ivec3& chunkCoord, Heightmap& out) {
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	std::array<float, CHUNKSIZE * CHUNKSIZE> xs, zs;
+
+	for (int x = 0; x < CHUNKSIZE; x++) {
+		for (int z = 0; z < CHUNKSIZE; z++) {
+			xs[x * CHUNKSIZE + z] = float(origin.x + x) * FREQUENCY;
+			zs[x * CHUNKSIZE + z] = float(origin.z + z) * FREQUENCY;
+		}
+	}
+
+	noise::perlin(xs.data(), zs.data(), CHUNKSIZE * CHUNKSIZE, out.heights.data());
+
+	for (auto& height : out.heights)
+		height = SURFACELEVEL + height * SURFACEAMPLITUDE;
+}
+
+void terrain::sampleDensity(const glm::ivec3& chunkCoord, DensityLattice& out) {
+	constexpr int SAMPLES = LATTICESIZE * LATTICESIZE * LATTICESIZE;
+
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	std::array<float, SAMPLES> xs, ys, zs;
+
+	for (int x = 0; x < LATTICESIZE; x++) {
+		for (int y = 0; y < LATTICESIZE; y++) {
+			for (int z = 0; z < LATTICESIZE; z++) {
+				const int i = (x * LATTICESIZE + y) * LATTICESIZE + z;
+				xs[i] = float(origin.x + x * DENSITYSTEP) * FREQUENCY;
+				ys[i] = float(origin.y + y * DENSITYSTEP) * FREQUENCY;
+				zs[i] = float(origin.z + z * DENSITYSTEP) * FREQUENCY;
+			}
+		}
+	}
+
+	noise::perlin(xs.data(), ys.data(), zs.data(), SAMPLES, out.samples.data());
+}
+
+void terrain::generateBaseDensity(const glm::ivec3& chunkCoord, VoxelStorage& out, Heightmap& heightmap) {
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	computeHeightmap(chunkCoord, heightmap);
+
+	// written in the storage order and packed at once.
+	auto voxels = std::make_unique<VoxelBuffer>();
+
+	for (int x = 0; x < CHUNKSIZE; x++) {
+		for (int y = 0; y < CHUNKSIZE; y++) {
+			const int worldY = origin.y + y;
+
+			for (int z = 0; z < CHUNKSIZE; z++) {
+				const bool solid = worldY <= CAVELEVEL || worldY < heightmap.at(x, z);
+
+				(*voxels)[voxelIndex(x, y, z)] = solid ? groundId(worldY, origin.z + z) : VoxelId(Air);
+			}
+		}
+	}
+
+	out.assign(voxels->data());
+}
+
+void terrain::generateSurface(const glm::ivec3& chunkCoord, VoxelStorage& voxels, const Heightmap& heightmap) {
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	// the top voxel of a column is the last one under the surface height.
+	auto topOf = [&](int x, int z) { return static_cast<int>(std::ceil(heightmap.at(x, z))) - 1; };
+
+	const auto [lowest, highest] = std::minmax_element(heightmap.heights.begin(), heightmap.heights.end());
+	const int lowestTop = static_cast<int>(std::ceil(*lowest)) - 1 - DIRTDEPTH;
+	const int highestTop = static_cast<int>(std::ceil(*highest)) - 1;
+
+	if (highestTop < origin.y || lowestTop >= origin.y + CHUNKSIZE)
+		return;
+
+	auto buffer = unpack(voxels);
+
+	for (int x = 0; x < CHUNKSIZE; x++) {
+		for (int z = 0; z < CHUNKSIZE; z++) {
+			const int top = topOf(x, z);
+
+			// under the cave level the surface noise doesn't shape the ground.
+			if (top <= CAVELEVEL)
+				continue;
+
+			const int first = std::max(top - DIRTDEPTH, origin.y);
+			const int last = std::min(top, origin.y + CHUNKSIZE - 1);
+
+			for (int worldY = first; worldY <= last; worldY++) {
+				auto& voxel = (*buffer)[voxelIndex(x, worldY - origin.y, z)];
+				if (voxel != Air)
+					voxel = worldY == top ? Grass : Dirt;
+			}
+		}
+	}
+
+	voxels.assign(buffer->data());
+}
+
+void terrain::carveCaves(const glm::ivec3& chunkCoord, VoxelStorage& voxels) {
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	// amount of voxel layers of the chunk at or below the cave level.
+	const int caveRows = std::clamp(CAVELEVEL - origin.y + 1, 0, CHUNKSIZE);
+
+	if (caveRows == 0)
+		return;
+
+	auto density = std::make_unique<DensityLattice>();
+	sampleDensity(chunkCoord, *density);
+
+	auto buffer = unpack(voxels);
+
+	for (int x = 0; x < CHUNKSIZE; x++)
+		for (int y = 0; y < caveRows; y++)
+			for (int z = 0; z < CHUNKSIZE; z++)
+				if (density->interpolate(x, y, z) < 0)
+					(*buffer)[voxelIndex(x, y, z)] = Air;
+
+	voxels.assign(buffer->data());
+}
+
+void terrain::decorate(const glm::ivec3& chunkCoord, VoxelStorage& voxels, const HeightmapNeighbourhood& heightmaps) {
+	const auto origin = chunkCoord * CHUNKSIZE;
+
+	// only fills air, so trunks and leaves never replace the ground or each other.
+	auto place = [&](int worldX, int worldY, int worldZ, VoxelId id) {
+		const glm::ivec3 local = glm::ivec3(worldX, worldY, worldZ) - origin;
+
+		if (glm::any(glm::lessThan(local, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(local, glm::ivec3(CHUNKSIZE))))
+			return;
+
+		if (voxels.get(local.x, local.y, local.z) == Air)
+			voxels.set(local.x, local.y, local.z, id);
+	};
+
+	// every tree that can reach the chunk, visited in the same (world) order by
+	// all the chunks it touches.
+	for (int x = -TREERADIUS; x < CHUNKSIZE + TREERADIUS; x++) {
+		for (int z = -TREERADIUS; z < CHUNKSIZE + TREERADIUS; z++) {
+			const int worldX = origin.x + x;
+			const int worldZ = origin.z + z;
+
+			const auto hash = columnHash(worldX, worldZ);
+			if (hash % TREECHANCE != 0)
+				continue;
+
+			// the ground there may have been carved by the caves.
+			const int baseY = static_cast<int>(std::ceil(heightmaps.at(x, z)));
+			if (baseY <= CAVELEVEL + 1)
+				continue;
+
+			const int topY = baseY + MINTRUNKHEIGHT + static_cast<int>((hash >> 16) % 3) - 1;
+
+			// the tree doesn't reach this chunk.
+			if (topY + 1 < origin.y || baseY >= origin.y + CHUNKSIZE)
+				continue;
+
+			for (int y = baseY; y <= topY; y++)
+				place(worldX, y, worldZ, Wood);
+
+			// two wide layers around the top of the trunk and a small one over it.
+			for (int y = topY - 1; y <= topY + 1; y++) {
+				const int radius = y > topY ? 1 : TREERADIUS;
+
+				for (int dx = -radius; dx <= radius; dx++) {
+					for (int dz = -radius; dz <= radius; dz++) {
+						if (std::abs(dx) == radius && std::abs(dz) == radius)
+							continue;
+
+						place(worldX + dx, y, worldZ + dz, Leaves);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+	:workers{},
+	jobs{},
+	running{ 0 },
+	stopping{ false } {
+
+	threadCount = std::max(threadCount, 1u);
+
+	for (unsigned int i = 0; i < threadCount; i++)
+		this->workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+		this->jobs.clear();
+	}
+
+	this->jobAvailable.notify_all();
+
+	for (auto& worker : this->workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->jobs.push_back(std::move(job));
+	}
+
+	this->jobAvailable.notify_one();
+}
+
+void ThreadPool::cancelPending() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->jobs.clear();
+	}
+
+	this->jobsDone.notify_all();
+}
+
+void ThreadPool::waitIdle() {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->jobsDone.wait(lock, [this]() { return this->jobs.empty() && this->running == 0; });
+}
+
+unsigned int ThreadPool::defaultThreadCount() {
+	const auto cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 1;
+}
+
+unsigned int ThreadPool::sharedThreadCount(unsigned int pools) {
+	return std::max(1u, defaultThreadCount() / std::max(1u, pools));
+}
+
+void ThreadPool::workerLoop() {
+	for (;;) {
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->jobAvailable.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+
+			if (this->stopping)
+				return;
+
+			job = std::move(this->jobs.front());
+			this->jobs.pop_front();
+			this->running++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->running--;
+		}
+
+		this->jobsDone.notify_all();
+	}
+}
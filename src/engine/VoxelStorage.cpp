@@ -0,0 +1,112 @@
+#include <algorithm>
+
+#include "VoxelStorage.hpp"
+
+VoxelStorage::VoxelStorage(VoxelId id)
+	:palette{ id },
+	words{},
+	bitsPerVoxel{ 0 },
+	voxelsPerWord{ 0 },
+	indexMask{ 0 } {
+}
+
+void VoxelStorage::set(int x, int y, int z, VoxelId id) {
+	auto it = std::find(this->palette.begin(), this->palette.end(), id);
+	auto paletteIndex = static_cast<uint64_t>(it - this->palette.begin());
+
+	if (it == this->palette.end()) {
+		this->palette.push_back(id);
+
+		// the new index doesn't fit, use the next power of two bit width.
+		if (this->palette.size() > (size_t(1) << this->bitsPerVoxel))
+			this->repack(this->bitsPerVoxel == 0 ? 1 : this->bitsPerVoxel * 2);
+	}
+	else if (this->bitsPerVoxel == 0) {
+		// writing the value the whole chunk already has.
+		return;
+	}
+
+	this->setIndex(voxelIndex(x, y, z), paletteIndex);
+}
+
+void VoxelStorage::fill(VoxelId id) {
+	this->palette.assign(1, id);
+	this->palette.shrink_to_fit();
+	this->words.clear();
+	this->words.shrink_to_fit();
+	this->bitsPerVoxel = 0;
+	this->voxelsPerWord = 0;
+	this->indexMask = 0;
+}
+
+void VoxelStorage::assign(const VoxelId* voxels) {
+	std::vector<VoxelId> newPalette{ voxels[0] };
+	std::vector<uint16_t> indices(CHUNKVOLUME);
+
+	// neighbouring voxels usually match, only search the palette when the id changes.
+	VoxelId last = voxels[0];
+	uint16_t lastIndex = 0;
+
+	for (int i = 0; i < CHUNKVOLUME; i++) {
+		if (voxels[i] != last) {
+			last = voxels[i];
+
+			auto it = std::find(newPalette.begin(), newPalette.end(), last);
+			lastIndex = static_cast<uint16_t>(it - newPalette.begin());
+
+			if (it == newPalette.end())
+				newPalette.push_back(last);
+		}
+
+		indices[i] = lastIndex;
+	}
+
+	if (newPalette.size() == 1) {
+		this->fill(newPalette[0]);
+		return;
+	}
+
+	int bits = 1;
+	while ((size_t(1) << bits) < newPalette.size())
+		bits *= 2;
+
+	this->palette = std::move(newPalette);
+	this->bitsPerVoxel = bits;
+	this->voxelsPerWord = 64 / bits;
+	this->indexMask = (uint64_t(1) << bits) - 1;
+	this->words.assign((CHUNKVOLUME + this->voxelsPerWord - 1) / this->voxelsPerWord, 0);
+
+	for (int i = 0; i < CHUNKVOLUME; i++)
+		this->setIndex(i, indices[i]);
+}
+
+void VoxelStorage::getRow(int x, int y, VoxelId* out) const {
+	if (this->bitsPerVoxel == 0) {
+		std::fill_n(out, CHUNKSIZE, this->palette[0]);
+		return;
+	}
+
+	for (int z = 0; z < CHUNKSIZE; z++)
+		out[z] = this->get(x, y, z);
+}
+
+void VoxelStorage::repack(int bits) {
+	const auto oldWords = std::move(this->words);
+	const auto oldBits = this->bitsPerVoxel;
+	const auto oldPerWord = this->voxelsPerWord;
+	const auto oldMask = this->indexMask;
+
+	this->bitsPerVoxel = bits;
+	this->voxelsPerWord = 64 / bits;
+	this->indexMask = (uint64_t(1) << bits) - 1;
+	this->words.assign((CHUNKVOLUME + this->voxelsPerWord - 1) / this->voxelsPerWord, 0);
+
+	// from the single value mode every voxel keeps palette index 0.
+	if (oldBits == 0)
+		return;
+
+	for (int i = 0; i < CHUNKVOLUME; i++) {
+		const auto paletteIndex = (oldWords[i / oldPerWord] >> ((i % oldPerWord) * oldBits)) & oldMask;
+		this->setIndex(i, paletteIndex);
+	}
+}
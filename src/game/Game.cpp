@@ -14,6 +14,7 @@
 #include <Windows.h>
 
 #include "Types.hpp"
+#include "ChunkMap.hpp"
 #include "ShaderCreation.hpp"
 #include "TextureLoader.h"
 #include "Camera.hpp"
@@ -22,6 +23,10 @@
 #include "LightSource.hpp"
 #include "Frustum.hpp"
 #include "Application.hpp"
+#include "MeshingPipeline.hpp"
+#include "ChunkStreaming.hpp"
+#include "CaveCulling.hpp"
+#include "OcclusionCulling.hpp"
 
 const glm::vec4 SKYCOLOR{ 0.21, 0.78, 0.95, 1.0 };
 
@@ -38,20 +43,18 @@ int main(void) {
 	rendering::Renderer renderer{};
 	renderer.attatchObject(cl.get());
 
-	// dont forget to delete this
-	Array3D<ChunkMesh2*, WORLDSIZE, WORLDSIZE, WORLDSIZE> world{};
-
-	for (int x = 0; x < WORLDSIZE; x++) {
-		for (int y = 0; y < WORLDSIZE; y++) {
-			for (int z = 0; z < WORLDSIZE; z++) {
-				auto chunk = new ChunkMesh2(glm::vec3((float)x, (float)y, (float)z));
-				chunk->generateChunk();
-				world.at(x, y, z) = chunk;
-				renderer.attatchObject(chunk);
-			}
-		}
-	}
+	ChunkMap<ChunkMesh2*> world{};
+
+	MeshingPipeline meshingPipeline{ renderer };
+	rendering::FrameUniformBuffer frameUniforms{};
+
+	// owns the chunks in world, loads them around the camera.
+	ChunkStreamer streamer{ world, renderer, meshingPipeline };
 
+	// hides the chunks walled off from the camera by terrain.
+	CaveCuller caveCuller;
+	// hides the chunks behind the solid ground in front of the camera.
+	OcclusionCuller occlusionCuller;
 
 	float lastTime = glfwGetTime();
 	unsigned int frameCount = 0;
@@ -90,6 +93,7 @@ int main(void) {
 		auto py = app->getCamera().getPosition().y;
 		auto pz = app->getCamera().getPosition().z;
 
+		frameUniforms.update(app->getCamera(), *cl);
 		frustum.update(app->getCamera());
 
 		auto ctx = app->getContext();
@@ -97,12 +101,24 @@ int main(void) {
 		ctx.world = &world;
 		ctx.frustum = &frustum;
 
+		streamer.update(app->getCamera().getPosition());
+		meshingPipeline.update(ctx);
+
+		caveCuller.update(ctx);
+		ctx.caveCuller = &caveCuller;
+
+		occlusionCuller.update(ctx);
+		ctx.occlusionCuller = &occlusionCuller;
+
 		renderer.render(ctx);
 
 		glfwSwapBuffers(app->getWindow());
 		glfwPollEvents();
 	}
 
+	// chunks own GL buffers, free them while the context exists.
+	streamer.unloadAll();
+
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
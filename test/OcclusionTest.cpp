@@ -0,0 +1,140 @@
+// Headless checks of occlusion::DepthBuffer, built once with the SIMD paths and
+// once with OCCLUSION_NO_SIMD. Returns non zero if a check fails.
+
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Occlusion.hpp"
+#include "ThreadPool.hpp"
+
+using namespace occlusion;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+// @brief true if the segment from @eye to @point goes through @box before reaching @point.
+static bool blocks(const Box& box, const glm::vec3& eye, const glm::vec3& point) {
+	const auto direction = point - eye;
+	float enter = 0.0f, leave = 1.0f;
+
+	for (int axis = 0; axis < 3; axis++) {
+		if (std::abs(direction[axis]) < 1e-9f) {
+			if (eye[axis] < box.min[axis] || eye[axis] > box.max[axis])
+				return false;
+			continue;
+		}
+
+		float t0 = (box.min[axis] - eye[axis]) / direction[axis];
+		float t1 = (box.max[axis] - eye[axis]) / direction[axis];
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		enter = std::max(enter, t0);
+		leave = std::min(leave, t1);
+	}
+
+	return enter <= leave;
+}
+
+static glm::mat4 lookingAt(const glm::vec3& eye, const glm::vec3& target) {
+	return glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f) * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+static void wallScene() {
+	const glm::vec3 eye{ 0.0f };
+	const auto pv = lookingAt(eye, glm::vec3(0.0f, 0.0f, -1.0f));
+
+	DepthBuffer buffer{ 256, 128 };
+	buffer.render(pv, eye, { { { -10.0f, -2.0f, -12.0f }, { 10.0f, 2.0f, -10.0f } } });
+
+	check(!buffer.isVisible({ -1.0f, -1.0f, -30.0f }, { 1.0f, 1.0f, -20.0f }), "a box behind the wall is hidden");
+	check(buffer.isVisible({ -1.0f, -1.0f, -8.0f }, { 1.0f, 1.0f, -6.0f }), "a box in front of the wall is visible");
+	check(buffer.isVisible({ 30.0f, -1.0f, -30.0f }, { 32.0f, 1.0f, -28.0f }), "a box beside the wall is visible");
+
+	// boxes behind the wall peeking over its top by a fraction of a pixel must
+	// never be hidden, wherever the top edge falls inside its row of pixels.
+	const float pixel = 2.0f * std::tan(glm::radians(30.0f)) / buffer.getHeight();
+
+	for (int edge = 0; edge < 10; edge++) {
+		// slope (y / -z) of the top of the wall seen from the eye.
+		const float top = 0.2f + pixel * edge / 10.0f;
+		buffer.render(pv, eye, { { { -10.0f, -2.0f, -12.0f }, { 10.0f, 10.0f * top, -10.0f } } });
+
+		for (int step = 1; step < 10; step++) {
+			const float peek = pixel * step / 10.0f;
+			check(buffer.isVisible({ -1.0f, 0.0f, -32.0f }, { 1.0f, 30.0f * (top + peek), -30.0f }), "a box peeking over the wall is visible");
+		}
+	}
+}
+
+static void randomScene() {
+	std::mt19937 rng{ 7 };
+	std::uniform_real_distribution<float> spread{ -40.0f, 40.0f };
+	std::uniform_real_distribution<float> size{ 2.0f, 16.0f };
+
+	const glm::vec3 eye{ 3.0f, 20.0f, 5.0f };
+	const auto pv = lookingAt(eye, eye + glm::vec3(0.4f, -0.3f, -1.0f));
+
+	std::vector<Box> occluders;
+	for (int i = 0; i < 200; i++) {
+		const glm::vec3 min{ spread(rng), spread(rng) * 0.5f, spread(rng) - 40.0f };
+		occluders.push_back({ min, min + glm::vec3(size(rng), size(rng), size(rng)) });
+	}
+
+	DepthBuffer single{ 256, 128 };
+	single.render(pv, eye, occluders);
+
+	ThreadPool pool{ 3 };
+	DepthBuffer banded{ 256, 128 };
+	banded.render(pv, eye, occluders, &pool);
+
+	int different = 0;
+	for (int y = 0; y < single.getHeight(); y++)
+		for (int x = 0; x < single.getWidth(); x++)
+			different += single.depthAt(x, y) != banded.depthAt(x, y);
+	check(different == 0, "drawing in bands gives the same buffer");
+
+	// points on screen that no occluder stands in front of must stay visible.
+	int hidden = 0;
+	for (int i = 0; i < 20000; i++) {
+		const glm::vec3 point{ spread(rng), spread(rng) * 0.5f, spread(rng) - 40.0f };
+
+		const auto clip = pv * glm::vec4(point, 1.0f);
+		if (clip.w < NEARW || std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w)
+			continue;
+
+		const bool blocked = std::any_of(occluders.begin(), occluders.end(),
+			[&](const Box& box) { return blocks(box, eye, point); });
+
+		const bool visible = single.isVisible(point - 0.01f, point + 0.01f);
+		if (!blocked && !visible) {
+			check(false, "a box no occluder hides is visible");
+			break;
+		}
+
+		hidden += !visible;
+	}
+
+	check(hidden > 0, "some boxes behind the occluders are hidden");
+}
+
+int main() {
+	wallScene();
+	randomScene();
+
+	if (failures == 0)
+		std::printf("all occlusion checks passed\n");
+
+	return failures == 0 ? 0 : 1;
+}